@@ -0,0 +1,77 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_CASEMAPPING_HPP
+#define IRC_CASEMAPPING_HPP
+
+#include "types.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace irc {
+
+/**
+ * How a server compares nicks and channel names, the CASEMAPPING
+ * token of RPL_ISUPPORT (005)
+ */
+enum class casemapping : unsigned char {
+	ascii,         //A-Z are the upper case of a-z
+	rfc1459,       //as ascii, plus []\^ are the upper case of {}|~
+	strict_rfc1459 //as ascii, plus []\ are the upper case of {}|
+}; //enum class casemapping
+
+/**
+ * @param value the CASEMAPPING value, eg "rfc1459"
+ * @param cm    set if value is known
+ * @return false if value isn't a casemapping we know, cm is left as is
+ */
+bool parse_casemapping(string_view value, casemapping& cm);
+
+/**
+ * @return the lower case of c under cm
+ */
+char fold_char(char c, casemapping cm);
+
+/**
+ * @return s in lower case under cm
+ */
+std::string fold_case(string_view s, casemapping cm);
+
+/**
+ * @return true if a and b are the same name under cm
+ */
+bool equal_folded(string_view a, string_view b, casemapping cm);
+
+/**
+ * A nick or channel name folded to lower case for use as a map key
+ *
+ * The name is folded and hashed in one pass on construction and the hash
+ * is kept, so "#Foo" and "#foo" are one key and a lookup hashes nothing
+ * more.
+ */
+class folded_key {
+	std::string folded_;
+	std::size_t hash_;
+public:
+	folded_key(string_view name, casemapping cm);
+
+	const std::string& str()  const;
+	std::size_t        hash() const;
+
+	bool operator==(const folded_key& other) const;
+	bool operator!=(const folded_key& other) const;
+}; //class folded_key
+
+struct folded_key_hash {
+	std::size_t operator()(const folded_key& key) const {
+		return key.hash();
+	}
+}; //struct folded_key_hash
+
+} //namespace irc
+
+#endif //IRC_CASEMAPPING_HPP
@@ -9,12 +9,13 @@
 
 #include "crtp_channel.hpp"
 #include "deref.hpp"
+#include "flat_hash.hpp"
+#include "lazy_signal.hpp"
 #include "types.hpp"
 #include "modes.hpp"
 
 #include <boost/iterator/transform_iterator.hpp>
 
-#include <unordered_set>
 #include <string>
 
 namespace irc {
@@ -23,7 +24,7 @@ class channel_impl;
 
 template<typename T>
 struct channel_traits {
-	using user_container      =std::unordered_set<shared_user>;
+	using user_container      =flat_hash_set<shared_user>;
 	using user_iterator       =boost::transform_iterator<deref, user_container::iterator>;
 	using const_user_iterator =boost::transform_iterator<deref, user_container::const_iterator>;
 }; //class channel_traits
@@ -43,14 +44,14 @@ private:
 	user_container        users_;
 	mode_block            modes_;
 //signals
-	sig_ch          on_channel_part;
-	sig_ch_usr_s    on_message;
-	sig_ch_s        on_topic_change;
-	sig_ch_usr      on_user_join;
-	sig_ch_usr_os   on_user_part;
-	sig_ch_usr_s    on_user_quit;
-	sig_ch          on_list_users;
-	sig_ch_p_usr_md on_user_mode_change;
+	lazy_signal<sig_ch>          on_channel_part;
+	lazy_signal<sig_ch_usr_s>    on_message;
+	lazy_signal<sig_ch_s>        on_topic_change;
+	lazy_signal<sig_ch_usr>      on_user_join;
+	lazy_signal<sig_ch_usr_os>   on_user_part;
+	lazy_signal<sig_ch_usr_s>    on_user_quit;
+	lazy_signal<sig_ch>          on_list_users;
+	lazy_signal<sig_ch_p_usr_md> on_user_mode_change;
 //deleted functions
 	channel_impl(const channel_impl&)           =delete;
 	channel_impl(channel_impl&&)                =delete;
@@ -59,6 +60,8 @@ private:
 
 	//helpers
 	bool is_nick_in_channel(const std::string& nick) const;
+	void erase_user(const shared_user& user);
+	void clear_users();
 public:
 	/**
 	 * Constructor.
@@ -66,6 +69,10 @@ public:
 	 * @param name_        The channel name.
 	 */
 	channel_impl(session& connection__, std::string name_);
+	/**
+	 * Destructor, takes the channel off its members' channel lists.
+	 */
+	~channel_impl();
 	/**
 	 * Returns the associated session object.
 	 * @return The associated session object.
@@ -182,9 +189,10 @@ public:
 	/**
 	 * Adds the specified modes to the channel.
 	 * @param pfx   The user prefix who sets the new modes.
-	 * @param modes The new modes.
+	 * @param modes The new modes, modes on members of the channel
+	 *              are taken out of it.
 	 */
-	void apply_mode_diff(const prefix& pfx, mode_diff modes);
+	void apply_mode_diff(const prefix& pfx, mode_diff& modes);
 	/**
 	 * Sends a message to the channel.
 	 * @param user    The user who sent the message.
@@ -229,7 +237,8 @@ public:
 	 */
 	void list_users(); //prompts observers to list users
 	/**
-	 * Sends a command::part request to the IRC server to leave this channel.
+	 * We have left this channel, signals on_channel_part then
+	 * forgets the members as they are no longer tracked.
 	 */
 	void part();
 	/**
@@ -241,7 +250,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_privmsg_impl(F&& f);
+	template<typename F> signal_connection connect_on_privmsg_impl(F&& f);
 	/**
 	 * Connect to the on_topic signal.
 	 * This signal is triggered when the topic has changed.
@@ -251,7 +260,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_topic_change_impl(F&& f);
+	template<typename F> signal_connection connect_on_topic_change_impl(F&& f);
 	/**
 	 * Connect to the on_user_join signal.
 	 * This signal is triggered when an user joins the channel.
@@ -261,7 +270,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_user_join_impl(F&& f);
+	template<typename F> signal_connection connect_on_user_join_impl(F&& f);
 	/**
 	 * Connect to the on_user_join signal.
 	 * This signal is triggered when an user leaves the channel.
@@ -271,7 +280,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_user_part_impl(F&& f);
+	template<typename F> signal_connection connect_on_user_part_impl(F&& f);
 	/**
 	 * Connect to the on_user_quit signal.
 	 * This signal is triggered when a user in this channel quit the irc server
@@ -281,7 +290,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_user_quit_impl(F&& f);
+	template<typename F> signal_connection connect_on_user_quit_impl(F&& f);
 	/**
 	 * Connect to the on_channel_part signal.
 	 * This signal is triggered when we leave the channel.
@@ -291,7 +300,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_channel_part_impl(F&& f);
+	template<typename F> signal_connection connect_on_channel_part_impl(F&& f);
 	/**
 	 * Connect to the on_list_users signal.
 	 * This signal is triggered when we required a command::list.
@@ -301,7 +310,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_list_users_impl(F&& f);
+	template<typename F> signal_connection connect_on_list_users_impl(F&& f);
 	/**
 	 * Connect to the on_set_mode signal.
 	 * This signal is triggered when channel has modes set
@@ -312,7 +321,7 @@ public:
 	 * @endcode
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_mode_change_impl(F&& f);
+	template<typename F> signal_connection connect_on_mode_change_impl(F&& f);
 	/**
 	 * Connect to the on_user_mode_change signal.
 	 * This signal is triggered when the mode for a user in channel
@@ -326,41 +335,41 @@ public:
 	 * @endcode
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_user_mode_change_impl(F&& f);
+	template<typename F> signal_connection connect_on_user_mode_change_impl(F&& f);
 }; //class channel
 
 
 // Template impl
 template<typename F>
-bsig::connection channel_impl::connect_on_privmsg_impl(F&& f) {
+signal_connection channel_impl::connect_on_privmsg_impl(F&& f) {
 	return on_message.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection channel_impl::connect_on_user_join_impl(F&& f) {
+signal_connection channel_impl::connect_on_user_join_impl(F&& f) {
 	return on_user_join.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection channel_impl::connect_on_user_quit_impl(F&& f) {
+signal_connection channel_impl::connect_on_user_quit_impl(F&& f) {
 	return on_user_quit.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection channel_impl::connect_on_user_part_impl(F&& f) {
+signal_connection channel_impl::connect_on_user_part_impl(F&& f) {
 	return on_user_part.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection channel_impl::connect_on_channel_part_impl(F&& f) {
+signal_connection channel_impl::connect_on_channel_part_impl(F&& f) {
 	return on_channel_part.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection channel_impl::connect_on_topic_change_impl(F&& f) {
+signal_connection channel_impl::connect_on_topic_change_impl(F&& f) {
 	return on_topic_change.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection channel_impl::connect_on_list_users_impl(F&& f) {
+signal_connection channel_impl::connect_on_list_users_impl(F&& f) {
 	return on_list_users.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection channel_impl::connect_on_mode_change_impl(F&& f) {
+signal_connection channel_impl::connect_on_mode_change_impl(F&& f) {
 	return modes_.connect_on_mode_change(
 		[=](const prefix& pfx, const mode_diff& md) {
 			f(*this, pfx, md);
@@ -368,7 +377,7 @@ bsig::connection channel_impl::connect_on_mode_change_impl(F&& f) {
 	);
 }
 template<typename F>
-bsig::connection channel_impl::connect_on_user_mode_change_impl(F&& f) {
+signal_connection channel_impl::connect_on_user_mode_change_impl(F&& f) {
 	return on_user_mode_change.connect(std::forward<F>(f));
 }
 
@@ -9,6 +9,8 @@
 #ifndef IRC_CLIENT_COMMAND_HPP
 #define IRC_CLIENT_COMMAND_HPP
 
+#include "types.hpp"
+
 #include <type_traits>
 #include <string>
 
@@ -21,10 +23,45 @@ using raw_command_t=std::underlying_type<command>::type;
 //maximum value occupied by RPLs and ERR values
 constexpr raw_command_t rpl_max=999;
 
+//checks whether an integral value names an enum value, never throws
+bool is_command(raw_command_t value);
+
+//looks up a named command such as "PRIVMSG", never throws
+//returns false if token isn't a known verb
+bool verb_to_command(string_view token, command& cmd);
+
 //convert an integral value to the enum type, checks to ensure value is in range
 //assuming value is in the range of raw_command_t
 command to_command(raw_command_t value);
 
+/**
+ * the kind of message a command is
+ */
+enum class command_class : unsigned char {
+	unknown, //not a command
+	reply,   //RPL_ numeric
+	error,   //ERR_ numeric
+	verb     //named command, eg PRIVMSG
+}; //enum class command_class
+
+/**
+ * static information about a command
+ */
+struct command_info {
+	const char*   name; //the C MACRO like name used in the IRC RFC
+	command_class type;
+}; //struct command_info
+
+/**
+ * looks up the information for a command, this is a single array index
+ */
+const command_info& get_command_info(command cmd);
+
+/**
+ * returns whether cmd is a reply, an error or a verb
+ */
+command_class get_command_class(command cmd);
+
 /**
  * converts an irc::command to a string with the C MACRO like name
  * used in the IRC RFC
@@ -1424,9 +1461,193 @@ enum class command
 
     TOPIC \#test\n; Command to check the topic for \#test.
 */
-    topic
+    topic,
+/**
+    RFC 2812 PASS <password\>: sets a connection password before registration.
+*/
+    pass,
+/**
+    RFC 2812 USER <user\> <mode\> <unused\> <realname\>: registers the username and realname.
+*/
+    user,
+/**
+    RFC 2812 OPER <name\> <password\>: requests operator privileges.
+*/
+    oper,
+/**
+    RFC 2812 SERVICE: registers a new service.
+*/
+    service,
+/**
+    RFC 2812 SQUIT <server\> <comment\>: disconnects a server link.
+*/
+    squit,
+/**
+    RFC 2812 NAMES [ <channel\> ]: lists the nicknames visible on channels.
+*/
+    names,
+/**
+    RFC 2812 LIST [ <channel\> ]: lists channels and their topics.
+*/
+    list,
+/**
+    RFC 2812 INVITE <nickname\> <channel\>: invites a user to a channel.
+*/
+    invite,
+/**
+    RFC 2812 MOTD [ <target\> ]: requests the message of the day.
+*/
+    motd,
+/**
+    RFC 2812 LUSERS: requests statistics about the size of the network.
+*/
+    lusers,
+/**
+    RFC 2812 VERSION [ <target\> ]: requests the server version.
+*/
+    version,
+/**
+    RFC 2812 STATS [ <query\> ]: requests server statistics.
+*/
+    stats,
+/**
+    RFC 2812 LINKS: lists the servers known to the server.
+*/
+    links,
+/**
+    RFC 2812 TIME [ <target\> ]: requests the local time of a server.
+*/
+    time,
+/**
+    RFC 2812 CONNECT: asks a server to link to another server.
+*/
+    connect,
+/**
+    RFC 2812 TRACE [ <target\> ]: finds the route to a server or user.
+*/
+    trace,
+/**
+    RFC 2812 ADMIN [ <target\> ]: requests the server administrator.
+*/
+    admin,
+/**
+    RFC 2812 INFO [ <target\> ]: requests information describing the server.
+*/
+    info,
+/**
+    RFC 2812 SERVLIST: lists the services on the network.
+*/
+    servlist,
+/**
+    RFC 2812 SQUERY <servicename\> <text\>: a PRIVMSG to a service.
+*/
+    squery,
+/**
+    RFC 2812 WHO [ <mask\> ]: queries users matching a mask.
+*/
+    who,
+/**
+    RFC 2812 WHOIS <mask\>: queries information about a user.
+*/
+    whois,
+/**
+    RFC 2812 WHOWAS <nickname\>: queries a nickname which no longer exists.
+*/
+    whowas,
+/**
+    RFC 2812 KILL <nickname\> <comment\>: closes a client connection.
+*/
+    kill,
+/**
+    RFC 2812 AWAY [ <text\> ]: sets or clears the away message, IRCv3 away-notify relays it.
+*/
+    away,
+/**
+    RFC 2812 REHASH: asks the server to reload its configuration.
+*/
+    rehash,
+/**
+    RFC 2812 DIE: asks the server to shut down.
+*/
+    die,
+/**
+    RFC 2812 RESTART: asks the server to restart.
+*/
+    restart,
+/**
+    RFC 2812 SUMMON: asks a user on the server host to join IRC.
+*/
+    summon,
+/**
+    RFC 2812 USERS: lists users logged into the server host.
+*/
+    users,
+/**
+    RFC 2812 WALLOPS <text\>: a message to every user with mode +w.
+*/
+    wallops,
+/**
+    RFC 2812 USERHOST <nickname\>: queries the hostmasks of nicknames.
+*/
+    userhost,
+/**
+    RFC 2812 ISON <nickname\>: queries which nicknames are online.
+*/
+    ison,
+/**
+    IRCv3 CAP <subcommand\>: client capability negotiation.
+*/
+    cap,
+/**
+    IRCv3 AUTHENTICATE <data\>: SASL authentication.
+*/
+    authenticate,
+/**
+    IRCv3 ACCOUNT <accountname\>: account-notify, a user logged in or out.
+*/
+    account,
+/**
+    IRCv3 BATCH +/-<reference\> [ <type\> ]: starts or ends a batch.
+*/
+    batch,
+/**
+    IRCv3 CHGHOST <user\> <host\>: a user's username or host changed.
+*/
+    chghost,
+/**
+    IRCv3 SETNAME <realname\>: a user's realname changed.
+*/
+    setname,
+/**
+    IRCv3 TAGMSG <target\>: a message carrying only tags.
+*/
+    tagmsg,
+/**
+    IRCv3 MONITOR <subcommand\>: nickname online tracking.
+*/
+    monitor,
+/**
+    IRCv3 FAIL <command\> <code\>: a standard reply for a failure.
+*/
+    fail,
+/**
+    IRCv3 WARN <command\> <code\>: a standard reply for a warning.
+*/
+    warn,
+/**
+    IRCv3 NOTE <command\> <code\>: a standard reply for information.
+*/
+    note,
+/**
+    Any command not listed above,
+    the token as received is kept in irc::message::raw_command.
+*/
+    unknown
 };
 
+//maximum value occupied by any command
+constexpr raw_command_t command_max=static_cast<raw_command_t>(command::unknown);
+
 } // namespace irc
 
 #endif //IRC_CLIENT_COMMAND_HPP
@@ -8,14 +8,14 @@
 #define IRC_CONNECTION_HPP
 
 #include "types.hpp"
+#include "line_buffer.hpp"
+#include "write_queue.hpp"
 
 #include <boost/asio/io_service.hpp>
-#include <boost/asio/streambuf.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 #include <memory> //shared_ptr
 #include <string>
-#include <deque>
 
 namespace irc {
 /**
@@ -46,7 +46,7 @@ public:
 	 * @endcode
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_resolve(F&& f);
+	template<typename F> signal_connection connect_on_resolve(F&& f);
 	/**
 	 * Connect to the on_connect signal.
 	 * This signal is triggered when connected to an IRC server.
@@ -56,17 +56,18 @@ public:
 	 * @endcode
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_connect(F&& f); 
+	template<typename F> signal_connection connect_on_connect(F&& f); 
 	/**
 	 * Connect to the on_read_msg signal.
 	 * This signal is triggered when an IRC server message was read.
 	 *
 	 * @param f A callback function with the following signature:
-	 * @code void f(const std::string& msg)
+	 * @code void f(irc::string_view msg)
 	 * @endcode
+	 * The line is only valid for the duration of the call.
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_read_msg(F&& f);
+	template<typename F> signal_connection connect_on_read_msg(F&& f);
 	/**
 	 * Connect to the on_network_error signal.
 	 * This signal is triggered when there was a connection error.
@@ -76,7 +77,7 @@ public:
 	 * @endcode
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_network_error(F&& f);
+	template<typename F> signal_connection connect_on_network_error(F&& f);
 	/**
 	 * Constructor.
 	 * @param io_service A reference to the ASIO io_service.
@@ -99,6 +100,11 @@ public:
 	 * @param str Data to push back to the write buffer.
 	 */
 	void async_write(std::string str);
+	/**
+	 * Sets the most bytes of queued messages sent in a single write.
+	 * @param max_bytes The cap, a larger single message is still sent whole.
+	 */
+	void set_max_write_bytes(std::size_t max_bytes);
 private:
 	//the move constructors could be achieved using the PIMPL idiom
 	connection()                            =delete;
@@ -120,19 +126,18 @@ private:
 	void handle_write(  const boost::system::error_code& error,
 	                    std::size_t bytes_transferred);
 
-	const std::string                     delim_{ "\r\n" };
 	states                                state_{ states::resolving };
 //signals
 	sig_v  on_resolve;
 	sig_v  on_connect;
-	sig_s  on_read_msg;
+	sig_sv on_read_msg;
 	sig_s  on_network_error;
 
 //asio related
-	std::deque<std::string>                  write_buffer_;
+	write_queue                              write_buffer_;
 
 	boost::asio::ip::tcp::resolver::iterator endpoints_;
-	boost::asio::streambuf                   streambuf_;
+	line_buffer                              read_buffer_;
 	boost::asio::ip::tcp::socket             socket_;
 	boost::asio::ip::tcp::resolver           resolver_;
 	boost::asio::ip::tcp::resolver::query    query_;
@@ -140,22 +145,22 @@ private:
 
 
 template<typename F> 
-bsig::connection connection::connect_on_resolve(F&& f) {
+signal_connection connection::connect_on_resolve(F&& f) {
 	return on_resolve.connect(std::forward<F>(f));
 }
 
 template<typename F> 
-bsig::connection connection::connect_on_connect(F&& f) {
+signal_connection connection::connect_on_connect(F&& f) {
 	return on_connect.connect(std::forward<F>(f));
 }
 
 template<typename F>
-bsig::connection connection::connect_on_read_msg(F&& f) {
+signal_connection connection::connect_on_read_msg(F&& f) {
 	return on_read_msg.connect(std::forward<F>(f));
 }
 
 template<typename F>
-bsig::connection connection::connect_on_network_error(F&& f) {
+signal_connection connection::connect_on_network_error(F&& f) {
 	return on_network_error.connect(std::forward<F>(f));
 }
 
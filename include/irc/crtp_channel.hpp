@@ -143,7 +143,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_user_join(F&& f);
+	template<typename F> signal_connection connect_on_user_join(F&& f);
 	/**
 	 * Connect to the on_user_join signal.
 	 * This signal is triggered when an user leaves the channel.
@@ -157,7 +157,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_user_part(F&& f);
+	template<typename F> signal_connection connect_on_user_part(F&& f);
 	/**
 	 * Connect to the on_channel_join signal.
 	 * This signal is triggered when you part from a channel, usually as
@@ -170,7 +170,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_channel_part(F&& f);
+	template<typename F> signal_connection connect_on_channel_part(F&& f);
 	/**
 	 * Connect to the on_user_quit signal.
 	 * This signal is triggered when an user in this channel quit the IRC server
@@ -186,7 +186,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_user_quit(F&& f);
+	template<typename F> signal_connection connect_on_user_quit(F&& f);
 	/**
 	 * Connect to the on_privmsg signal.
 	 * This signal is triggered when a PRIVMSG was sent to the channel.
@@ -200,7 +200,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_privmsg(F&& f);
+	template<typename F> signal_connection connect_on_privmsg(F&& f);
 	/**
 	 * Connect to the on_topic signal.
 	 * This signal is triggered when the topic has changed.
@@ -210,7 +210,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_topic_change(F&& f);
+	template<typename F> signal_connection connect_on_topic_change(F&& f);
 	/**
 	 * Connect to the on_list_users signal.
 	 * This signal is triggered when we required a command::list.
@@ -220,7 +220,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_list_users(F&& f);
+	template<typename F> signal_connection connect_on_list_users(F&& f);
 	/**
 	 * Connect to the on_mode_change signal.
 	 * This signal is triggered when channel has modes have been change
@@ -232,7 +232,7 @@ public:
 	 * @endcode
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_mode_change(F&& f);
+	template<typename F> signal_connection connect_on_mode_change(F&& f);
 	/**
 	 * Connect to the on_user_mode_change signal.
 	 * This signal is triggered when the mode for a user in channel
@@ -246,7 +246,7 @@ public:
 	 * @endcode
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_user_mode_change(F&& f);
+	template<typename F> signal_connection connect_on_user_mode_change(F&& f);
 }; //class crtp_channel
 
 //HELPERS
@@ -345,47 +345,47 @@ void crtp_channel<ImplType>::send_part(const std::string& msg) {
 //SIGNAL REGISTRATION
 template<typename ImplType>
 template<typename F> 
-bsig::connection crtp_channel<ImplType>::connect_on_user_join(F&& f) {
+signal_connection crtp_channel<ImplType>::connect_on_user_join(F&& f) {
 	return get_impl(*this).connect_on_user_join_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F> 
-bsig::connection crtp_channel<ImplType>::connect_on_user_part(F&& f) {
+signal_connection crtp_channel<ImplType>::connect_on_user_part(F&& f) {
 	return get_impl(*this).connect_on_user_part_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F> 
-bsig::connection crtp_channel<ImplType>::connect_on_channel_part(F&& f) {
+signal_connection crtp_channel<ImplType>::connect_on_channel_part(F&& f) {
 	return get_impl(*this).connect_on_channel_part_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F> 
-bsig::connection crtp_channel<ImplType>::connect_on_user_quit(F&& f) {
+signal_connection crtp_channel<ImplType>::connect_on_user_quit(F&& f) {
 	return get_impl(*this).connect_on_user_quit_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F> 
-bsig::connection crtp_channel<ImplType>::connect_on_privmsg(F&& f) {
+signal_connection crtp_channel<ImplType>::connect_on_privmsg(F&& f) {
 	return get_impl(*this).connect_on_privmsg_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F> 
-bsig::connection crtp_channel<ImplType>::connect_on_topic_change(F&& f) {
+signal_connection crtp_channel<ImplType>::connect_on_topic_change(F&& f) {
 	return get_impl(*this).connect_on_topic_change_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F> 
-bsig::connection crtp_channel<ImplType>::connect_on_list_users(F&& f) {
+signal_connection crtp_channel<ImplType>::connect_on_list_users(F&& f) {
 	return get_impl(*this).connect_on_list_users_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F> 
-bsig::connection crtp_channel<ImplType>::connect_on_mode_change(F&& f) {
+signal_connection crtp_channel<ImplType>::connect_on_mode_change(F&& f) {
 	return get_impl(*this).connect_on_mode_change_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F> 
-bsig::connection crtp_channel<ImplType>::connect_on_user_mode_change(F&& f) {
+signal_connection crtp_channel<ImplType>::connect_on_user_mode_change(F&& f) {
 	return get_impl(*this).connect_on_user_mode_change_impl(std::forward<F>(f));
 }
 
@@ -8,6 +8,7 @@
 #define IRC_CRTP_USER_HPP
 
 #include <string>
+#include <vector>
 #include "types.hpp"
 
 namespace irc {
@@ -43,6 +44,11 @@ public:
 	 * @see get_modes
 	 */
 	const mode_block & get_modes() const;
+	/**
+	 * @brief returns the channels this user is known to be in
+	 * @return the channels, in no particular order
+	 */
+	const std::vector<channel_impl*>& get_channels() const;
 	/**
 	 * @brief connect to the on_channel_message signal
 	 *
@@ -56,7 +62,7 @@ public:
 	 * @return the connection object to disconnect from the signal
 	 */
 	template<typename F>
-	bsig::connection connect_on_channel_message(F&& f);
+	signal_connection connect_on_channel_message(F&& f);
 	/**
 	 * @brief connect to the on_direct_message signal
 	 *
@@ -70,7 +76,7 @@ public:
 	 * @return the connection object to disconnect from the signal
 	 */
 	template<typename F>
-	bsig::connection connect_on_direct_message(F&& f);
+	signal_connection connect_on_direct_message(F&& f);
 	/**
 	 * @brief connect to the on_nick_change signal
 	 *
@@ -83,7 +89,7 @@ public:
 	 * @return the connection object to disconnect from the signal
 	 */	
 	template<typename F>
-	bsig::connection connect_on_nick_change(F&& f);
+	signal_connection connect_on_nick_change(F&& f);
 	/**
 	 * @brief connect to the on_notice signal
 	 *
@@ -96,7 +102,7 @@ public:
 	 * @return the connection object to disconnect from the signal
 	 */
 	template<typename F>
-	bsig::connection connect_on_notice(F&& f);
+	signal_connection connect_on_notice(F&& f);
 	/**
 	 * Connect to the on_set_change signal.
 	 * This signal is triggered when user's modes changed.
@@ -107,7 +113,7 @@ public:
 	 * @endcode
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_mode_change(F&& f);
+	template<typename F> signal_connection connect_on_mode_change(F&& f);
 
 }; //class crtp_user
 
@@ -138,31 +144,35 @@ template<typename ImplType>
 mode_block& crtp_user<ImplType>::get_modes() {
 	return get_impl(*this).get_modes_impl();
 }
+template<typename ImplType>
+const std::vector<channel_impl*>& crtp_user<ImplType>::get_channels() const {
+	return get_impl(*this).get_channels_impl();
+}
 
 //SIGNALS
 template<typename ImplType>
 template<typename F>
-bsig::connection crtp_user<ImplType>::connect_on_channel_message(F&& f) {
+signal_connection crtp_user<ImplType>::connect_on_channel_message(F&& f) {
 	return get_impl(*this).connect_on_channel_message_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F>
-bsig::connection crtp_user<ImplType>::connect_on_direct_message(F&& f) {
+signal_connection crtp_user<ImplType>::connect_on_direct_message(F&& f) {
 	return get_impl(*this).connect_on_direct_message_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F>
-bsig::connection crtp_user<ImplType>::connect_on_nick_change(F&& f) {
+signal_connection crtp_user<ImplType>::connect_on_nick_change(F&& f) {
 	return get_impl(*this).connect_on_nick_change_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F>
-bsig::connection crtp_user<ImplType>::connect_on_notice(F&& f) {
+signal_connection crtp_user<ImplType>::connect_on_notice(F&& f) {
 	return get_impl(*this).connect_on_notice_impl(std::forward<F>(f));
 }
 template<typename ImplType>
 template<typename F>
-bsig::connection crtp_user<ImplType>::connect_on_mode_change(F&& f) {
+signal_connection crtp_user<ImplType>::connect_on_mode_change(F&& f) {
 	return get_impl(*this).connect_on_mode_change_impl(std::forward<F>(f));
 }
 
@@ -6,6 +6,8 @@
 #ifndef IRC_CTCP_HPP
 #define IRC_CTCP_HPP
 
+#include "types.hpp"
+
 namespace irc {
 /**
     CTCP namespace.
@@ -228,6 +230,13 @@ enum class command
     ctcp_max = version /**< CTCP command mask. **/
 };
 
+/**
+    Looks up a CTCP tag such as "VERSION".
+    @param tag The tag, without the leading \001.
+    @return The command or command::none if the tag isn't known.
+*/
+command to_command(string_view tag);
+
 } // namespace ctcp
 } // namespace irc
 
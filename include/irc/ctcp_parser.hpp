@@ -14,6 +14,8 @@
 
 #include <boost/fusion/include/vector.hpp>
 #include <boost/spirit/home/qi.hpp>
+#include <boost/spirit/include/phoenix_bind.hpp>
+#include <boost/spirit/include/phoenix_operator.hpp>
 
 #include <string>
 
@@ -21,6 +23,12 @@ namespace irc {
 
 namespace fsn = boost::fusion;
 namespace qi  = boost::spirit::qi;
+namespace phx = boost::phoenix;
+
+inline ctcp::command to_ctcp_command(const std::string& tag)
+{
+    return ctcp::to_command(tag);
+}
 
 template<typename Iterator>
 struct ctcp_parser : qi::grammar<Iterator,
@@ -39,14 +47,15 @@ struct ctcp_parser : qi::grammar<Iterator,
         qi::attr_type attr;
         qi::char_type char_;
         qi::lit_type  lit;
+        qi::_1_type   _1;
+        qi::_val_type _val;
+        qi::_pass_type _pass;
 
-        ctcp_cmd.add
-        ("ACTION",  ctcp::command::action)("CLIENTINFO", ctcp::command::clientinfo)
-        ("DCC",     ctcp::command::dcc)   ("ERRMSG",     ctcp::command::errmsg)
-        ("FINGER",  ctcp::command::finger)("PING",       ctcp::command::ping)
-        ("SED",     ctcp::command::sed)   ("SOURCE",     ctcp::command::source)
-        ("TIME",    ctcp::command::time)  ("USERINFO",   ctcp::command::userinfo)
-        ("VERSION", ctcp::command::version);
+        // The tag is looked up in ctcp::to_command's perfect hash,
+        // unknown tags fail so the message is treated as plain text
+        ctcp_tag  %= +~char_(" \001");
+        ctcp_cmd   = ctcp_tag[ _val  = phx::bind(to_ctcp_command, _1),
+                               _pass = _val != ctcp::command::none ];
 
         ctcp_args %= +~char_('\001');
         ctcp_msg  %= ( (lit('\001') >> ctcp_cmd) >> -ctcp_args )
@@ -55,7 +64,8 @@ struct ctcp_parser : qi::grammar<Iterator,
 
 private:
     rule_ss<std::string>                          ctcp_args;
-    qi::symbols<char, ctcp::command>              ctcp_cmd;
+    rule_ss<std::string>                          ctcp_tag;
+    rule_ss<ctcp::command>                        ctcp_cmd;
     rule<fsn::vector<ctcp::command, std::string>> ctcp_msg;
 };
 
@@ -0,0 +1,318 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_FLAT_HASH_HPP
+#define IRC_FLAT_HASH_HPP
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace irc {
+
+namespace detail {
+
+/**
+ * Open addressing hash table with linear probing
+ *
+ * The values sit in one array and a parallel array of one byte tags
+ * marks which slots are used and holds 7 bits of the hash, so a probe
+ * only compares keys when the tags match. Erasing shifts the following
+ * entries back rather than leaving tombstones.
+ *
+ * Like std::unordered_map, inserting may invalidate iterators. Unlike
+ * it, inserting may also move the values, and erasing invalidates
+ * iterators and references to other entries.
+ */
+template<typename Value, typename Key, typename KeyOf, typename Hash, typename KeyEqual>
+class flat_table {
+public:
+	using key_type   =Key;
+	using value_type =Value;
+	using size_type  =std::size_t;
+	using hasher     =Hash;
+	using key_equal  =KeyEqual;
+private:
+	using slot_type=typename std::aligned_storage<sizeof(Value), alignof(Value)>::type;
+
+	static constexpr std::uint8_t empty_tag=0;
+
+	std::unique_ptr<std::uint8_t[]> tags_;
+	std::unique_ptr<slot_type[]>    slots_;
+	size_type                       capacity_ { 0 };
+	size_type                       size_     { 0 };
+	unsigned                        shift_    { 64 };
+	Hash                            hash_;
+	KeyEqual                        equal_;
+
+	Value&       slot(size_type i)       { return *reinterpret_cast<Value*>(&slots_[i]); }
+	const Value& slot(size_type i) const { return *reinterpret_cast<const Value*>(&slots_[i]); }
+
+	//spreads the hash, std::hash of a pointer leaves the low bits empty
+	std::uint64_t mix(const Key& key) const {
+		return static_cast<std::uint64_t>(hash_(key)) * 0x9e3779b97f4a7c15ull;
+	}
+	size_type home(std::uint64_t h) const {
+		return static_cast<size_type>(h >> shift_);
+	}
+	static std::uint8_t tag(std::uint64_t h) {
+		return static_cast<std::uint8_t>(0x80 | (h & 0x7f));
+	}
+
+	//the slot holding key or the empty slot where it would go
+	std::pair<size_type, bool> probe(const Key& key, std::uint64_t h) const {
+		const auto t=tag(h);
+		const auto mask=capacity_-1;
+		for(size_type i=home(h); ; i=(i+1) & mask) {
+			if(tags_[i] == empty_tag) return { i, false };
+			if(tags_[i] == t && equal_(KeyOf()(slot(i)), key)) return { i, true };
+		}
+	}
+
+	void grow() {
+		size_type capacity=capacity_ ? capacity_*2 : 16;
+		unsigned  shift   =shift_ - (capacity_ ? 1 : 4);
+
+		std::unique_ptr<std::uint8_t[]> tags { new std::uint8_t[capacity]() };
+		std::unique_ptr<slot_type[]>    slots { new slot_type[capacity] };
+
+		std::swap(tags_, tags);
+		std::swap(slots_, slots);
+		std::swap(capacity_, capacity);
+		shift_=shift;
+
+		//capacity, tags and slots now hold the old table
+		const auto mask=capacity_-1;
+		for(size_type i=0; i!=capacity; ++i) {
+			if(tags[i] == empty_tag) continue;
+			Value& v=*reinterpret_cast<Value*>(&slots[i]);
+			auto h=mix(KeyOf()(v));
+			size_type j=home(h);
+			while(tags_[j] != empty_tag) j=(j+1) & mask;
+			::new (&slots_[j]) Value(std::move(v));
+			tags_[j]=tags[i];
+			v.~Value();
+		}
+	}
+
+	void erase_at(size_type i) {
+		const auto mask=capacity_-1;
+		slot(i).~Value();
+		//shift back any entry which isn't in its home slot
+		for(size_type j=(i+1) & mask; tags_[j] != empty_tag; j=(j+1) & mask) {
+			size_type h=home(mix(KeyOf()(slot(j))));
+			//can j's entry move to i without passing its home
+			if(((j - h) & mask) < ((j - i) & mask)) continue;
+			::new (&slots_[i]) Value(std::move(slot(j)));
+			tags_[i]=tags_[j];
+			slot(j).~Value();
+			i=j;
+		}
+		tags_[i]=empty_tag;
+		--size_;
+	}
+
+	template<typename... Args>
+	std::pair<size_type, bool> emplace_key(const Key& key, Args&&... args) {
+		if((size_+1)*8 > capacity_*7) grow();
+		auto h=mix(key);
+		auto r=probe(key, h);
+		if(r.second) return { r.first, false };
+
+		::new (&slots_[r.first]) Value(std::forward<Args>(args)...);
+		tags_[r.first]=tag(h);
+		++size_;
+		return { r.first, true };
+	}
+public:
+	template<bool Const>
+	class iterator_impl
+	:	public boost::iterator_facade<iterator_impl<Const>,
+		                              typename std::conditional<Const, const Value, Value>::type,
+		                              boost::forward_traversal_tag> {
+		friend class boost::iterator_core_access;
+		friend class flat_table;
+		template<bool> friend class iterator_impl;
+
+		using table_ptr=typename std::conditional<Const, const flat_table*, flat_table*>::type;
+
+		table_ptr table_ { nullptr };
+		size_type pos_   { 0 };
+
+		iterator_impl(table_ptr table, size_type pos)
+		:	table_ ( table )
+		,	pos_   ( pos )
+		{
+			skip();
+		}
+		void skip() {
+			while(pos_ < table_->capacity_ && table_->tags_[pos_] == empty_tag) ++pos_;
+		}
+		void increment() {
+			++pos_;
+			skip();
+		}
+		bool equal(const iterator_impl& other) const {
+			return pos_ == other.pos_;
+		}
+		typename iterator_impl::reference dereference() const {
+			return table_->slot(pos_);
+		}
+	public:
+		iterator_impl()=default;
+
+		template<bool OtherConst, typename=typename std::enable_if<Const && !OtherConst>::type>
+		iterator_impl(const iterator_impl<OtherConst>& other)
+		:	table_ ( other.table_ )
+		,	pos_   ( other.pos_ )
+		{	}
+	}; //class iterator_impl
+
+	using iterator      =iterator_impl<false>;
+	using const_iterator=iterator_impl<true>;
+
+	flat_table()=default;
+	flat_table(const flat_table&)=delete;
+	flat_table& operator=(const flat_table&)=delete;
+
+	flat_table(flat_table&& other) {
+		swap(other);
+	}
+	flat_table& operator=(flat_table&& other) {
+		flat_table tmp { std::move(other) };
+		swap(tmp);
+		return *this;
+	}
+	~flat_table() {
+		clear();
+	}
+
+	void swap(flat_table& other) {
+		std::swap(tags_,     other.tags_);
+		std::swap(slots_,    other.slots_);
+		std::swap(capacity_, other.capacity_);
+		std::swap(size_,     other.size_);
+		std::swap(shift_,    other.shift_);
+		std::swap(hash_,     other.hash_);
+		std::swap(equal_,    other.equal_);
+	}
+
+	iterator       begin()        { return iterator { this, 0 }; }
+	iterator       end()          { return iterator { this, capacity_ }; }
+	const_iterator begin()  const { return const_iterator { this, 0 }; }
+	const_iterator end()    const { return const_iterator { this, capacity_ }; }
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend()   const { return end(); }
+
+	size_type size()  const { return size_; }
+	bool      empty() const { return size_ == 0; }
+
+	iterator find(const Key& key) {
+		if(size_ == 0) return end();
+		auto r=probe(key, mix(key));
+		return r.second ? iterator { this, r.first } : end();
+	}
+	const_iterator find(const Key& key) const {
+		if(size_ == 0) return end();
+		auto r=probe(key, mix(key));
+		return r.second ? const_iterator { this, r.first } : end();
+	}
+	size_type count(const Key& key) const {
+		return find(key) == end() ? 0 : 1;
+	}
+
+	void erase(const_iterator it) {
+		assert(it.table_ == this && it.pos_ < capacity_);
+		erase_at(it.pos_);
+	}
+	size_type erase(const Key& key) {
+		auto it=find(key);
+		if(it == end()) return 0;
+		erase_at(it.pos_);
+		return 1;
+	}
+
+	void clear() {
+		for(size_type i=0; i!=capacity_; ++i) {
+			if(tags_[i] != empty_tag) {
+				slot(i).~Value();
+				tags_[i]=empty_tag;
+			}
+		}
+		size_=0;
+	}
+protected:
+	template<typename... Args>
+	std::pair<iterator, bool> emplace_unique(const Key& key, Args&&... args) {
+		auto r=emplace_key(key, std::forward<Args>(args)...);
+		return { iterator { this, r.first }, r.second };
+	}
+}; //class flat_table
+
+template<typename Value, typename Key, typename KeyOf, typename Hash, typename KeyEqual>
+constexpr std::uint8_t flat_table<Value, Key, KeyOf, Hash, KeyEqual>::empty_tag;
+
+template<typename Pair>
+struct pair_first {
+	const typename Pair::first_type& operator()(const Pair& p) const { return p.first; }
+};
+
+template<typename T>
+struct identity {
+	const T& operator()(const T& v) const { return v; }
+};
+
+} //namespace detail
+
+/**
+ * Flat replacement for std::unordered_map
+ * @see detail::flat_table for when iterators and references are invalidated
+ */
+template<typename Key, typename Mapped,
+         typename Hash=std::hash<Key>, typename KeyEqual=std::equal_to<Key>>
+class flat_hash_map
+:	public detail::flat_table<std::pair<const Key, Mapped>, Key,
+	                          detail::pair_first<std::pair<const Key, Mapped>>,
+	                          Hash, KeyEqual> {
+public:
+	using mapped_type=Mapped;
+	using typename flat_hash_map::flat_table::iterator;
+
+	std::pair<iterator, bool> emplace(Key key, Mapped mapped) {
+		const Key& k=key;
+		return this->emplace_unique(k, std::move(key), std::move(mapped));
+	}
+	Mapped& operator[](const Key& key) {
+		return this->emplace_unique(key, key, Mapped { }).first->second;
+	}
+}; //class flat_hash_map
+
+/**
+ * Flat replacement for std::unordered_set
+ * @see detail::flat_table for when iterators and references are invalidated
+ */
+template<typename Key, typename Hash=std::hash<Key>, typename KeyEqual=std::equal_to<Key>>
+class flat_hash_set
+:	public detail::flat_table<Key, Key, detail::identity<Key>, Hash, KeyEqual> {
+public:
+	using typename flat_hash_set::flat_table::iterator;
+
+	std::pair<iterator, bool> insert(Key key) {
+		const Key& k=key;
+		return this->emplace_unique(k, std::move(key));
+	}
+}; //class flat_hash_set
+
+} //namespace irc
+
+#endif //IRC_FLAT_HASH_HPP
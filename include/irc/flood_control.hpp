@@ -0,0 +1,130 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_FLOOD_CONTROL_HPP
+#define IRC_FLOOD_CONTROL_HPP
+
+#include "types.hpp"
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <cstddef>
+
+namespace irc {
+
+/**
+ * The outbound budget, the full allowance of lines and bytes is
+ * regained over each window. A zero lines or bytes disables that limit.
+ */
+struct flood_limits {
+	std::size_t               lines  { 10 };
+	std::size_t               bytes  { 4096 };
+	std::chrono::milliseconds window { 10000 };
+}; //struct flood_limits
+
+/**
+ * Token bucket scheduler for outbound messages
+ *
+ * Messages wait in one lane per write_priority, the lanes are served
+ * strictly in order. urgent messages (PONG, registration) are never
+ * held back, they still use up budget so lower lanes will wait longer.
+ */
+class flood_control {
+public:
+	using clock     =std::chrono::steady_clock;
+	using time_point=clock::time_point;
+	using duration  =clock::duration;
+private:
+	static constexpr std::size_t lane_count=
+		static_cast<std::size_t>(write_priority::bulk) + 1;
+
+	std::array<std::deque<std::string>, lane_count> lanes_;
+	flood_limits limits_;
+	double       line_tokens_, byte_tokens_;
+	time_point   last_refill_;
+	std::size_t  queued_bytes_ { 0 };
+
+	void   refill(time_point now);
+	bool   can_send(write_priority p, const std::string& msg) const;
+	void   spend(const std::string& msg);
+	double lines_per_tick() const;
+	double bytes_per_tick() const;
+public:
+	/**
+	 * @param limits the budget, starts with a full allowance
+	 * @param now    the time to measure refills from
+	 */
+	explicit flood_control(flood_limits limits=flood_limits{ },
+	                       time_point now=clock::now());
+	/**
+	 * queues a message in the lane for p
+	 */
+	void push(std::string msg, write_priority p);
+	/**
+	 * calls f with each message, highest priority first, for as long
+	 * as the budget allows
+	 *
+	 * @code void f(std::string msg) @endcode
+	 *
+	 * @param lowest the last lane to take from, the ones below wait
+	 * @return the number of messages sent
+	 */
+	template<typename F>
+	std::size_t drain(time_point now, F&& f,
+	                  write_priority lowest=write_priority::bulk);
+	/**
+	 * returns how long until the next queued message can be sent,
+	 * zero if it can be sent now or nothing is queued
+	 */
+	duration next_ready(time_point now) const;
+	/**
+	 * returns the estimated time for all queued messages to be sent
+	 */
+	duration expected_drain_time(time_point now) const;
+	/**
+	 * returns the number of messages waiting
+	 */
+	std::size_t queue_depth() const;
+	/**
+	 * returns the number of messages waiting in the lane for p
+	 */
+	std::size_t queue_depth(write_priority p) const;
+	/**
+	 * drops every waiting message
+	 */
+	void clear();
+
+	void                set_limits(flood_limits limits);
+	const flood_limits& get_limits() const;
+}; //class flood_control
+
+template<typename F>
+std::size_t flood_control::drain(time_point now, F&& f, write_priority lowest) {
+	refill(now);
+	std::size_t n=0;
+	for(std::size_t i=0; i<=static_cast<std::size_t>(lowest); ++i) {
+		auto& lane=lanes_[i];
+		auto  p   =static_cast<write_priority>(i);
+		while(!lane.empty()) {
+			//strict priority, a lower lane never overtakes a waiting higher one
+			if(!can_send(p, lane.front())) return n;
+
+			std::string msg=std::move(lane.front());
+			lane.pop_front();
+			queued_bytes_-=msg.size();
+			spend(msg);
+			f(std::move(msg));
+			++n;
+		}
+	}
+	return n;
+}
+
+} //namespace irc
+
+#endif //IRC_FLOOD_CONTROL_HPP
@@ -0,0 +1,125 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_HANDLER_ALLOCATOR_HPP
+#define IRC_HANDLER_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace irc {
+
+/**
+ * A block of memory reused by one chain of asynchronous operations
+ *
+ * Asio allocates storage for every operation it starts, a socket which
+ * only ever has one read outstanding can hand it the same block each
+ * time. Anything too big, or asked for while the block is in use, goes
+ * to the global operator new.
+ */
+class handler_memory {
+	typename std::aligned_storage<512>::type storage_;
+	bool                                     in_use_ { false };
+public:
+	handler_memory()=default;
+	handler_memory(const handler_memory&)           =delete;
+	handler_memory& operator=(const handler_memory&)=delete;
+
+	void* allocate(std::size_t size) {
+		if(!in_use_ && size <= sizeof(storage_)) {
+			in_use_=true;
+			return &storage_;
+		}
+		return ::operator new(size);
+	}
+
+	void deallocate(void* p) {
+		if(p == &storage_) in_use_=false;
+		else               ::operator delete(p);
+	}
+
+	/**
+	 * @return true while an operation holds the block
+	 */
+	bool in_use() const {
+		return in_use_;
+	}
+}; //class handler_memory
+
+/**
+ * Allocator over a handler_memory, the type asio finds through a
+ * handler's get_allocator()
+ */
+template<typename T>
+class handler_allocator {
+	template<typename> friend class handler_allocator;
+	handler_memory& memory_;
+public:
+	using value_type=T;
+
+	explicit handler_allocator(handler_memory& memory)
+	:	memory_ ( memory )
+	{	}
+
+	template<typename U>
+	handler_allocator(const handler_allocator<U>& other) noexcept
+	:	memory_ ( other.memory_ )
+	{	}
+
+	T* allocate(std::size_t n) {
+		return static_cast<T*>(memory_.allocate(sizeof(T) * n));
+	}
+	void deallocate(T* p, std::size_t) {
+		memory_.deallocate(p);
+	}
+
+	template<typename U>
+	bool operator==(const handler_allocator<U>& other) const noexcept {
+		return &memory_ == &other.memory_;
+	}
+	template<typename U>
+	bool operator!=(const handler_allocator<U>& other) const noexcept {
+		return &memory_ != &other.memory_;
+	}
+}; //class handler_allocator
+
+/**
+ * Wraps a completion handler so asio allocates its operation from a
+ * handler_memory
+ */
+template<typename Handler>
+class alloc_handler {
+	handler_memory& memory_;
+	Handler         handler_;
+public:
+	using allocator_type=handler_allocator<Handler>;
+
+	alloc_handler(handler_memory& memory, Handler handler)
+	:	memory_  ( memory )
+	,	handler_ ( std::move(handler) )
+	{	}
+
+	allocator_type get_allocator() const noexcept {
+		return allocator_type { memory_ };
+	}
+
+	template<typename... Args>
+	void operator()(Args&&... args) {
+		handler_(std::forward<Args>(args)...);
+	}
+}; //class alloc_handler
+
+template<typename Handler>
+alloc_handler<typename std::decay<Handler>::type>
+make_alloc_handler(handler_memory& memory, Handler&& handler) {
+	return { memory, std::forward<Handler>(handler) };
+}
+
+} //namespace irc
+
+#endif //IRC_HANDLER_ALLOCATOR_HPP
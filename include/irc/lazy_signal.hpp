@@ -0,0 +1,58 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_LAZY_SIGNAL_HPP
+#define IRC_LAZY_SIGNAL_HPP
+
+#include <memory>
+#include <utility>
+
+namespace irc {
+
+/**
+ * Wraps a signal which is only created when something connects to it
+ *
+ * Users and channels carry several signals each which almost never get
+ * a subscriber, an empty pointer is all they cost until one does.
+ * Emitting with nothing connected is a single null check.
+ */
+template<typename Signal>
+class lazy_signal {
+	std::unique_ptr<Signal> sig_;
+public:
+	lazy_signal()=default;
+	lazy_signal(lazy_signal&&)=default;
+	lazy_signal& operator=(lazy_signal&&)=default;
+
+	/**
+	 * Connects f, creating the signal on the first call
+	 * @return the connection object to disconnect from the signal
+	 */
+	template<typename F>
+	auto connect(F&& f) -> decltype(std::declval<Signal&>().connect(std::forward<F>(f))) {
+		if(!sig_) sig_.reset(new Signal);
+		return sig_->connect(std::forward<F>(f));
+	}
+
+	/**
+	 * Emits the signal if anything has ever connected to it
+	 */
+	template<typename... Args>
+	void operator()(Args&&... args) const {
+		if(sig_) (*sig_)(std::forward<Args>(args)...);
+	}
+
+	/**
+	 * @return true if nothing has ever connected
+	 */
+	bool empty() const {
+		return !sig_;
+	}
+}; //class lazy_signal
+
+} //namespace irc
+
+#endif //IRC_LAZY_SIGNAL_HPP
@@ -0,0 +1,189 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_LIGHT_SIGNAL_HPP
+#define IRC_LIGHT_SIGNAL_HPP
+
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace irc {
+
+namespace detail {
+
+struct light_slot_base {
+	bool connected { true };
+};
+
+template<typename Signature>
+struct light_slot : light_slot_base {
+	std::function<Signature> fn;
+
+	template<typename F>
+	explicit light_slot(F&& f)
+	:	fn ( std::forward<F>(f) )
+	{	}
+};
+
+template<typename R>
+struct light_result {
+	using type=boost::optional<R>;
+};
+
+template<>
+struct light_result<void> {
+	using type=void;
+};
+
+} //namespace detail
+
+/**
+ * Handle to a slot connected to a light_signal, the counterpart of
+ * boost::signals2::connection. It is safe to disconnect after the signal
+ * has been destroyed.
+ */
+class light_connection {
+	std::weak_ptr<detail::light_slot_base> slot_;
+public:
+	light_connection()=default;
+
+	explicit light_connection(std::weak_ptr<detail::light_slot_base> slot)
+	:	slot_ ( std::move(slot) )
+	{	}
+
+	void disconnect() const {
+		if(auto s=slot_.lock()) s->connected=false;
+	}
+	bool connected() const {
+		auto s=slot_.lock();
+		return s && s->connected;
+	}
+}; //class light_connection
+
+template<typename Signature>
+class light_signal;
+
+/**
+ * Single threaded replacement for boost::signals2::signal
+ *
+ * Takes no lock and allocates only when a slot is connected, emitting
+ * walks the slot vector in place. Slots may connect and disconnect
+ * while the signal is being emitted, slots connected then are first
+ * called on the next emit. Disconnected slots are dropped once no emit
+ * is in progress. The signal must outlive any emit of itself.
+ *
+ * Like signals2, a signal with a non void result returns the result of
+ * the last slot called, or none if there wasn't one.
+ *
+ * Define IRC_LIGHT_SIGNALS to make the library's sig_ types use it.
+ */
+template<typename R, typename... Args>
+class light_signal<R(Args...)> {
+	using slot_type  =detail::light_slot<R(Args...)>;
+	using slot_ptr   =std::shared_ptr<slot_type>;
+public:
+	using result_type=typename detail::light_result<R>::type;
+private:
+	std::vector<slot_ptr> slots_;
+	unsigned              depth_ { 0 };
+	bool                  dirty_ { false };
+
+	struct emit_scope {
+		light_signal& sig;
+
+		explicit emit_scope(light_signal& s)
+		:	sig ( s )
+		{
+			++sig.depth_;
+		}
+		~emit_scope() {
+			if(--sig.depth_ == 0 && sig.dirty_) sig.sweep();
+		}
+	}; //struct emit_scope
+
+	void sweep() {
+		std::size_t out=0;
+		for(std::size_t i=0; i!=slots_.size(); ++i) {
+			if(slots_[i]->connected) slots_[out++]=std::move(slots_[i]);
+		}
+		slots_.resize(out);
+		dirty_=false;
+	}
+
+	void emit(std::true_type, Args&... args) {
+		emit_scope scope { *this };
+		//only the slots connected before the emit began
+		const std::size_t n=slots_.size();
+		for(std::size_t i=0; i!=n; ++i) {
+			slot_type& s=*slots_[i];
+			if(s.connected) s.fn(args...);
+			else            dirty_=true;
+		}
+	}
+
+	result_type emit(std::false_type, Args&... args) {
+		emit_scope scope { *this };
+		result_type result;
+		const std::size_t n=slots_.size();
+		for(std::size_t i=0; i!=n; ++i) {
+			slot_type& s=*slots_[i];
+			if(s.connected) result=s.fn(args...);
+			else            dirty_=true;
+		}
+		return result;
+	}
+public:
+	light_signal()=default;
+	light_signal(const light_signal&)           =delete;
+	light_signal& operator=(const light_signal&)=delete;
+	light_signal(light_signal&&)                =default;
+	light_signal& operator=(light_signal&&)     =default;
+
+	/**
+	 * @return the connection object to disconnect from the signal
+	 */
+	template<typename F>
+	light_connection connect(F&& f) {
+		if(depth_ == 0) sweep();
+		slots_.push_back(std::make_shared<slot_type>(std::forward<F>(f)));
+		return light_connection { slots_.back() };
+	}
+	/**
+	 * Forwards every emit to other, which has to outlive the connection
+	 */
+	template<typename Signature>
+	light_connection connect(light_signal<Signature>& other) {
+		auto* target=&other;
+		return connect([target](Args... args) { return (*target)(args...); });
+	}
+
+	result_type operator()(Args... args) {
+		return emit(std::is_void<R>(), args...);
+	}
+
+	void disconnect_all_slots() {
+		for(auto& s : slots_) s->connected=false;
+		if(depth_ == 0) sweep();
+		else            dirty_=true;
+	}
+
+	bool empty() const {
+		for(const auto& s : slots_) {
+			if(s->connected) return false;
+		}
+		return true;
+	}
+}; //class light_signal
+
+} //namespace irc
+
+#endif //IRC_LIGHT_SIGNAL_HPP
@@ -0,0 +1,92 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_LINE_BUFFER_HPP
+#define IRC_LINE_BUFFER_HPP
+
+#include "types.hpp"
+
+#include <boost/asio/buffer.hpp>
+
+#include <vector>
+#include <cstddef>
+
+namespace irc {
+
+/**
+ * Finds the first '\n' in [first, last), vectorised where the CPU allows
+ *
+ * @return a pointer to the '\n' or last if there is none
+ */
+const char* find_line_end(const char* first, const char* last);
+
+/**
+ * Receive buffer for a line based protocol
+ *
+ * Bytes are read straight into the buffer, every complete line is then
+ * handed out in a single scan and any partial line is kept for the
+ * next read.
+ */
+class line_buffer {
+	std::vector<char> buffer_;
+	std::size_t       size_ { 0 };
+
+	void compact(const char* first);
+public:
+	/**
+	 * @param capacity the initial capacity, grown if a line exceeds it
+	 */
+	explicit line_buffer(std::size_t capacity=4096);
+	/**
+	 * returns the free space at the end of the buffer to read into
+	 */
+	boost::asio::mutable_buffers_1 prepare();
+	/**
+	 * marks n bytes of the space returned by prepare() as received
+	 */
+	void commit(std::size_t n);
+	/**
+	 * calls f with each complete line, without its "\r\n", and then
+	 * discards them. f returns false to stop early, the remaining
+	 * lines are then kept.
+	 *
+	 * @code bool f(irc::string_view line) @endcode
+	 *
+	 * @return the number of lines consumed
+	 */
+	template<typename F> std::size_t consume_lines(F&& f);
+	/**
+	 * returns the number of bytes held, including partial lines
+	 */
+	std::size_t size() const;
+	/**
+	 * discards everything held
+	 */
+	void clear();
+}; //class line_buffer
+
+template<typename F>
+std::size_t line_buffer::consume_lines(F&& f) {
+	const char* first=buffer_.data();
+	const char* last =first + size_;
+	std::size_t n=0;
+
+	for(const char* eol; (eol=find_line_end(first, last)) != last; ) {
+		const char* end=eol;
+		if(end != first && end[-1] == '\r') --end;
+
+		bool more=f(string_view(first, end-first));
+		first=eol+1;
+		++n;
+		if(!more) break;
+	}
+	compact(first);
+	return n;
+}
+
+} //namespace irc
+
+#endif //IRC_LINE_BUFFER_HPP
@@ -12,17 +12,35 @@
 #include "types.hpp"
 #include "prefix.hpp"
 #include "command.hpp"
+#include "message_tags.hpp"
 
+#include <boost/container/small_vector.hpp>
+
+#include <cstddef>
 #include <vector>
 #include <string>
 
 namespace irc {
+/**
+    RFC 2812 limits a message to 15 parameters.
+*/
+constexpr std::size_t max_params=15;
+/**
+    Parameters of an owning @ref irc::message, held inline up to
+    the RFC limit.
+*/
+using param_list=boost::container::small_vector<std::string, max_params>;
+
 /**
     IRC message struct.
     Servers and clients send each other messages,
     which may or may not generate a reply.
 */
 struct message {
+/**
+    IRCv3 tag section as received, still escaped and without the '@'.
+*/
+	std::string              tags;
 /**
     Message prefix (optional).
 */
@@ -31,11 +49,20 @@ struct message {
     Message command.
 */
 	irc::command             command;
+/**
+    The command token as received, this is how a command::unknown
+    can still be identified.
+*/
+	std::string              raw_command;
 /**
     Message command parameters.
     RFC set this to a maximum of 15.
 */
-	std::vector<std::string> params; 
+	param_list               params;
+/**
+    @return A view over tags, valid for as long as tags isn't modified.
+*/
+	message_tags get_tags() const { return message_tags { tags }; }
 }; //struct message
 
 std::tuple<bool, message> parse_message(const std::string &raw_msg);
@@ -0,0 +1,98 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_MESSAGE_TAGS_HPP
+#define IRC_MESSAGE_TAGS_HPP
+
+#include "types.hpp"
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <string>
+
+namespace irc {
+
+/**
+    A single IRCv3 tag, both parts refer into the message buffer.
+    The value is still escaped, use unescaped_value() to decode it.
+*/
+struct tag_view {
+	string_view key;
+	string_view value;
+/**
+    @return The decoded value.
+*/
+	std::string unescaped_value() const;
+}; //struct tag_view
+
+/**
+    Decodes an IRCv3 tag value, "\:" becomes ';', "\s" a space and so on.
+    @param value The escaped value.
+    @param out   The string to append the decoded value to.
+*/
+void unescape_tag_value(string_view value, std::string& out);
+
+/**
+    Non owning view of the tag section of a message,
+    eg "time=2014-01-17T12:00:00.000Z;msgid=abc" without the leading '@'.
+    Nothing is split up front, every lookup walks the section
+    which for the handful of tags a server sends is cheaper than a map.
+*/
+class message_tags {
+	string_view raw_;
+public:
+	class const_iterator
+	:	public boost::iterator_facade<const_iterator, tag_view,
+		                              boost::forward_traversal_tag, tag_view> {
+		friend class boost::iterator_core_access;
+		string_view rest_;
+		tag_view    current_;
+		bool        end_ { true };
+
+		void      increment();
+		bool      equal(const const_iterator& other) const;
+		tag_view  dereference() const;
+	public:
+		const_iterator()=default;
+		explicit const_iterator(string_view raw);
+	}; //class const_iterator
+
+	message_tags()=default;
+/**
+    @param raw The tag section, must outlive this object.
+*/
+	explicit message_tags(string_view raw);
+
+	const_iterator begin() const;
+	const_iterator end()   const;
+	bool           empty() const;
+/**
+    @return The tag section as received.
+*/
+	string_view    raw()   const;
+/**
+    Finds the escaped value of a tag, when a key is repeated the last one wins.
+    A tag without a value gives an empty value.
+    @param key The tag key, eg "time" or "+example.com/foo".
+    @return The escaped value or none if the tag isn't present.
+*/
+	optional_string_view find(string_view key) const;
+/**
+    @param key The tag key.
+    @return @true if the tag is present.
+*/
+	bool contains(string_view key) const;
+/**
+    Finds and decodes the value of a tag.
+    @param key The tag key.
+    @return The decoded value or none if the tag isn't present.
+*/
+	optional_string get(string_view key) const;
+}; //class message_tags
+
+} //namespace irc
+
+#endif //IRC_MESSAGE_TAGS_HPP
@@ -0,0 +1,111 @@
+
+//          Copyright Joseph Dobson, Andrea Zanellato 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_MESSAGE_VIEW_HPP
+#define IRC_MESSAGE_VIEW_HPP
+
+#include "types.hpp"
+#include "prefix.hpp"
+#include "message.hpp"
+#include "command.hpp"
+#include "message_tags.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace irc {
+
+/**
+    Non owning @ref irc::prefix.
+    Each part refers into the buffer the message was parsed from.
+*/
+struct prefix_view {
+	optional_string_view nick, user, host;
+/**
+    Copies the referenced parts into an owning prefix.
+    @return The owning prefix.
+*/
+	prefix to_prefix() const;
+}; //struct prefix_view
+
+/**
+    Non owning IRC message.
+    A message_view is only valid for as long as the buffer it was
+    parsed from, use to_message() to keep it around any longer.
+*/
+struct message_view {
+	using param_container=std::array<string_view, max_params>;
+	using const_iterator =param_container::const_iterator;
+/**
+    IRCv3 message tags, empty if the line had none.
+*/
+	message_tags                 tags;
+/**
+    Message prefix (optional).
+*/
+	boost::optional<prefix_view> prefix;
+/**
+    Message command.
+*/
+	irc::command                 command;
+/**
+    The command token as received, eg "PRIVMSG" or "001".
+*/
+	string_view                  raw_command;
+/**
+    Message command parameters, only the first param_count are valid.
+*/
+	param_container              params;
+	std::size_t                  param_count { 0 };
+
+	const_iterator begin() const;
+	const_iterator end()   const;
+	std::size_t    size()  const;
+	bool           empty() const;
+	string_view    operator[](std::size_t n) const;
+/**
+    Copies the message into an owning irc::message.
+    @return The owning message.
+*/
+	message to_message() const;
+}; //struct message_view
+
+/**
+    Parses a single line, this doesn't allocate nor throw.
+    Trailing "\r\n" is ignored.
+
+    @param raw_msg The line to parse, must outlive @p msg.
+    @param msg     The view to fill in.
+    @return @true if the line was a valid message, @false otherwise.
+*/
+bool parse_message(string_view raw_msg, message_view& msg);
+
+/**
+    Parses every complete line in a buffer, eg a socket read or a log file.
+    @p msgs is cleared first but keeps its capacity, reusing the same
+    vector across batches means steady state parsing doesn't allocate.
+    Empty and malformed lines are skipped, a trailing partial line
+    is left for the caller to carry over to the next batch.
+
+    @param buffer The lines, each ending in "\n" or "\r\n",
+                  must outlive @p msgs.
+    @param msgs   The vector to fill with one view per valid line.
+    @param failed Set to the number of malformed lines skipped.
+    @return The number of bytes consumed, up to the end of the last complete line.
+*/
+std::size_t parse_messages(string_view                buffer,
+                           std::vector<message_view>& msgs,
+                           std::size_t&               failed);
+/**
+    @see parse_messages(string_view, std::vector<message_view>&, std::size_t&)
+*/
+std::size_t parse_messages(string_view                buffer,
+                           std::vector<message_view>& msgs);
+
+} //namespace irc
+
+#endif //IRC_MESSAGE_VIEW_HPP
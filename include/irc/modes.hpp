@@ -7,9 +7,12 @@
 #ifndef IRC_MODES_HPP
 #define IRC_MODES_HPP
 
+#include "lazy_signal.hpp"
 #include "types.hpp"
 
+#include <array>
 #include <ostream>
+#include <string>
 #include <vector>
 
 namespace irc {
@@ -18,11 +21,67 @@ enum class mode_change : bool {
 	set, unset
 }; //enum class mode_change
 
+/**
+ * The modes a single MODE line adds and removes
+ *
+ * clear() keeps the capacity so one diff can be reused for every line.
+ */
 struct mode_diff {
-	mode_change change;
-	mode_list   modes;
+	mode_list set;   //modes added, in the order given
+	mode_list unset; //modes removed, in the order given
+
+	void clear();
+	bool empty() const;
 }; //struct mode_diff
 
+/**
+ * How a channel mode takes its argument, see CHANMODES and PREFIX in
+ * the RPL_ISUPPORT (005) reply
+ */
+enum class mode_type : unsigned char {
+	flag,      //type D, never has an argument
+	list,      //type A, always has an argument, eg b
+	always,    //type B, always has an argument, eg k
+	on_set,    //type C, only has an argument when set, eg l
+	membership //PREFIX, always has a nick as argument, eg o and v
+}; //enum class mode_type
+
+/**
+ * The mode types a server supports, starts with the RFC 2811 set
+ * (CHANMODES=beI,k,l,imnpst PREFIX=(ov)@+) until the server says otherwise.
+ * Anything the server doesn't list is taken to be a flag.
+ */
+class mode_classes {
+	std::array<mode_type, 128> types_;
+	std::string                prefix_modes_, prefix_symbols_;
+public:
+	mode_classes();
+	/**
+	 * @param chanmodes the CHANMODES value, eg "beI,k,l,imnpst"
+	 */
+	void set_chanmodes(string_view chanmodes);
+	/**
+	 * @param prefix the PREFIX value, eg "(qaohv)~&@%+"
+	 * @return false if prefix is malformed, nothing is changed then
+	 */
+	bool set_prefix(string_view prefix);
+	/**
+	 * reads CHANMODES and PREFIX out of a single RPL_ISUPPORT token
+	 * such as "PREFIX=(ov)@+", other tokens are ignored
+	 */
+	void apply_isupport(string_view token);
+
+	mode_type get_type(char mode) const;
+	bool      takes_param(char mode, mode_change change) const;
+	/**
+	 * @return the mode for a NAMES prefix symbol, eg 'o' for '@', or '\0'
+	 */
+	char      mode_for_symbol(char symbol) const;
+
+	const std::string& get_prefix_modes()   const;
+	const std::string& get_prefix_symbols() const;
+}; //class mode_classes
+
 class mode_block {
 public:
 	using value_type    =mode_entry;
@@ -44,17 +103,17 @@ public:
 
 	optional_string try_get_mode_param(char sym);
 
-	template<typename F> bsig::connection connect_on_mode_change(F&& f);
+	template<typename F> signal_connection connect_on_mode_change(F&& f);
 private:
 	void set_mode_impl(char sym, const optional_string& param);
 	void unset_mode_impl(char sym);
 
-	sig_p_md  on_mode_change;
+	lazy_signal<sig_p_md> on_mode_change;
 	mode_list modes_;
 }; //class modes_block
 
 template<typename F>
-bsig::connection mode_block::connect_on_mode_change(F&& f) {
+signal_connection mode_block::connect_on_mode_change(F&& f) {
 	return on_mode_change.connect(std::forward<F>(f));
 }
 
@@ -66,8 +125,57 @@ std::string to_string(const mode_block& mb);
 std::string to_string(const mode_list& ml);
 std::string to_string(const mode_diff& md);
 
+/**
+ * Parses a MODE line in a single pass, each mode that takes an argument
+ * is paired with the next one, so "+o-v" "alice" "bob" ops alice and
+ * devoices bob.
+ *
+ * @param classes the server's mode types
+ * @param modes   the mode string, eg "+o-v+l"
+ * @param first   the first argument after the mode string
+ * @param last    one past the final argument
+ * @param md      cleared then filled in
+ * @return false if an argument was missing or modes had no sign,
+ *         md holds everything that could be parsed
+ */
+template<typename InputIt>
+bool parse_modes(const mode_classes& classes, string_view modes,
+                 InputIt first, InputIt last, mode_diff& md);
+
+/**
+ * parses "+modes arg1 arg2..." with the RFC 2811 mode types
+ */
 mode_diff parse_modes(const std::string& entries);
 
+template<typename InputIt>
+bool parse_modes(const mode_classes& classes, string_view modes,
+                 InputIt first, InputIt last, mode_diff& md) {
+	md.clear();
+	bool ok=!modes.empty() && (modes.front() == '+' || modes.front() == '-');
+	mode_list* target=&md.set;
+	auto change=mode_change::set;
+
+	for(char c : modes) {
+		if(c == '+' || c == '-') {
+			change=c == '+' ? mode_change::set : mode_change::unset;
+			target=c == '+' ? &md.set : &md.unset;
+			continue;
+		}
+		if(!classes.takes_param(c, change)) {
+			target->emplace_back(c, boost::none);
+		}
+		else if(first != last) {
+			target->emplace_back(c, std::string(first->data(), first->size()));
+			++first;
+		}
+		else {
+			target->emplace_back(c, boost::none);
+			ok=false;
+		}
+	}
+	return ok;
+}
+
 } //namespace irc
 
 #endif //IRC_MODES_HPP
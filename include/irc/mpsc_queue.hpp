@@ -0,0 +1,105 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_MPSC_QUEUE_HPP
+#define IRC_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace irc {
+
+/**
+ * Lock free queue with many producers and a single consumer
+ *
+ * Pushing is one allocation and one atomic exchange and never waits on
+ * another thread. The consumer always holds one node as a stub, each pop
+ * frees the old stub and the popped node takes its place.
+ *
+ * A push which has swapped in its node but not yet linked it is not
+ * visible to pop, empty() still reports it so the consumer can come
+ * back for it.
+ */
+template<typename T>
+class mpsc_queue {
+	struct node {
+		std::atomic<node*> next { nullptr };
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+		T& value() { return *reinterpret_cast<T*>(&storage); }
+	}; //struct node
+
+	std::atomic<node*> head_; //producers link on here
+	node*              tail_; //the stub, owned by the consumer
+public:
+	mpsc_queue()
+	:	head_ ( new node )
+	,	tail_ ( head_.load() )
+	{	}
+	mpsc_queue(const mpsc_queue&)           =delete;
+	mpsc_queue& operator=(const mpsc_queue&)=delete;
+
+	~mpsc_queue() {
+		T discard;
+		while(pop(discard)) { }
+		delete tail_;
+	}
+
+	/**
+	 * Safe from any thread.
+	 */
+	void push(T value) {
+		node* n=new node;
+		::new (&n->storage) T(std::move(value));
+		node* prev=head_.exchange(n, std::memory_order_acq_rel);
+		prev->next.store(n, std::memory_order_release);
+	}
+
+	/**
+	 * Consumer only.
+	 * @return false if there was nothing ready
+	 */
+	bool pop(T& out) {
+		node* next=tail_->next.load(std::memory_order_acquire);
+		if(!next) return false;
+		out=std::move(next->value());
+		next->value().~T();
+		delete tail_;
+		tail_=next;
+		return true;
+	}
+
+	/**
+	 * Consumer only, pops at most max values into f.
+	 * @return how many were popped
+	 */
+	template<typename F>
+	std::size_t drain(F f, std::size_t max) {
+		std::size_t n=0;
+		T value;
+		while(n != max && pop(value)) {
+			f(std::move(value));
+			++n;
+		}
+		return n;
+	}
+
+	/**
+	 * Consumer only.
+	 * @return true if nothing has been pushed, including pushes which
+	 *         are still being linked
+	 */
+	bool empty() const {
+		return head_.load(std::memory_order_acquire) == tail_;
+	}
+}; //class mpsc_queue
+
+} //namespace irc
+
+#endif //IRC_MPSC_QUEUE_HPP
@@ -1,10 +1,13 @@
 #ifndef IRC_PARSE_COLOURED_STRING_HPP
 #define IRC_PARSE_COLOURED_STRING_HPP
 
+#include "types.hpp"
+
 #include <string>
 #include <vector>
 #include <array>
 #include <bitset>
+#include <ostream>
 
 namespace irc {
 
@@ -72,11 +75,19 @@ text_modifiers text_modifier_cast(char value) {
 
 std::ostream& operator<<(std::ostream& os, colours val);
 
-struct rich_string {
+/**
+ * @return the modifier a control character stands for, or
+ *         text_modifiers::none if c isn't one
+ */
+text_modifiers modifier_for(char c);
+
+/**
+ * The formatting in effect for a run of text
+ */
+struct text_style {
 	std::bitset<max_text_modifiers> mods { 0 };
 	colours foreground                   { colours::none };
 	colours background                   { colours::none };
-	std::string value;
 
 	void set_modifier(text_modifiers, bool);
 	bool get_modifier(text_modifiers) const;
@@ -89,19 +100,104 @@ struct rich_string {
 	bool get_reverse() const;
 };
 
+struct rich_string : text_style {
+	std::string value;
+};
+
 using coloured_string = rich_string;
 
-struct text_diff {
-	text_modifiers modifier   { text_modifiers::none };
-	colours        foreground { colours::none        },
-	               background { colours::none        };
-	std::string    text;
+/**
+ * A run of text and its formatting, the text refers into the decoded string
+ */
+struct text_span {
+	text_style  style;
+	string_view text;
 };
 
 using split_string=std::vector<coloured_string>;
 
+namespace detail {
+
+//updates style for the control character mod, first is just past it,
+//returns the end of any colour digits that followed
+const char* apply_control(text_style& style, text_modifiers mod,
+                          const char* first, const char* last);
+
+} //namespace detail
+
+/**
+ * Decodes mIRC formatting in a single pass without allocating,
+ * f is called with each run of text in order.
+ *
+ * @code void f(const irc::text_style& style, irc::string_view text) @endcode
+ *
+ * A run starts at every control character, runs can be empty when two
+ * follow each other. Text before the first control character is only a
+ * run if there is some, and a control character at the very end isn't one.
+ * Colour numbers outside the 16 colour palette give colours::none.
+ *
+ * @param raw_msg the text to decode, the runs refer into it
+ */
+template<typename F>
+void visit_coloured_string(string_view raw_msg, F&& f);
+
+/**
+ * Decodes raw_msg into spans, spans is cleared first but keeps its
+ * capacity so reusing it avoids allocating.
+ *
+ * @return the number of spans
+ */
+std::size_t parse_coloured_string(string_view raw_msg, std::vector<text_span>& spans);
+
+/**
+ * Decodes raw_msg copying each run into its own string.
+ * @see visit_coloured_string
+ */
 split_string parse_coloured_string(const std::string& raw_msg);
 
+/**
+ * Finds the first formatting control character in [first, last),
+ * vectorised where the CPU allows
+ *
+ * @return a pointer to the control character or last if there is none
+ */
+const char* find_formatting(const char* first, const char* last);
+
+/**
+ * Removes all formatting, including colour numbers, leaving plain text.
+ * Text without any formatting is copied in one go.
+ */
+std::string strip_formatting(string_view raw_msg);
+
+/**
+ * Removes all formatting from msg in place.
+ * @see strip_formatting(string_view)
+ */
+void strip_formatting(std::string& msg);
+
+template<typename F>
+void visit_coloured_string(string_view raw_msg, F&& f) {
+	const char* first=raw_msg.data();
+	const char* last =first + raw_msg.size();
+	const char* run  =first;
+	text_style  style;
+
+	for(const char* it=first; it != last; ) {
+		//every control character is below a space
+		auto mod=static_cast<unsigned char>(*it) < 0x20
+			? modifier_for(*it) : text_modifiers::none;
+		if(mod == text_modifiers::none) {
+			++it;
+			continue;
+		}
+
+		if(it != first) f(static_cast<const text_style&>(style), string_view(run, it-run));
+		it =detail::apply_control(style, mod, it+1, last);
+		run=it;
+	}
+	if(run != last) f(static_cast<const text_style&>(style), string_view(run, last-run));
+}
+
 } //namespace irc
 
 #endif //IRC_PARSE_COLOURED_STRING_HPP
@@ -0,0 +1,135 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_PERFECT_HASH_HPP
+#define IRC_PERFECT_HASH_HPP
+
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace irc {
+
+/**
+ * Immutable map from a fixed set of tokens to values
+ *
+ * On construction a hash seed is searched for which places every key
+ * in its own slot, a lookup is then one hash, one slot and one compare
+ * no matter how many keys there are.
+ *
+ * @tparam Value the mapped type
+ * @tparam Slots the table size, a power of two comfortably larger than
+ *               the number of keys
+ */
+template<typename Value, std::size_t Slots>
+class perfect_hash_map {
+	static_assert(Slots != 0 && (Slots & (Slots-1)) == 0,
+		"Slots must be a power of two");
+public:
+	struct entry {
+		const char* key;
+		Value       value;
+	};
+private:
+	using index_type=std::uint16_t;
+	static constexpr index_type empty_slot=0xffff;
+
+	std::vector<entry>             entries_;
+	std::array<index_type, Slots>  slots_;
+	std::uint32_t                  seed_ { 0 };
+
+	static std::size_t slot_for(string_view key, std::uint32_t seed);
+	bool try_seed(std::uint32_t seed);
+public:
+	/**
+	 * @param entries the keys, which must be unique, and their values
+	 * @throws std::logic_error if no perfect seed could be found
+	 */
+	perfect_hash_map(std::initializer_list<entry> entries);
+	/**
+	 * @see perfect_hash_map(std::initializer_list<entry>)
+	 */
+	explicit perfect_hash_map(std::vector<entry> entries);
+	/**
+	 * @return the value for key or nullptr if key isn't in the map
+	 */
+	const Value* find(string_view key) const;
+
+	std::size_t size() const;
+}; //class perfect_hash_map
+
+template<typename Value, std::size_t Slots>
+constexpr typename perfect_hash_map<Value, Slots>::index_type
+perfect_hash_map<Value, Slots>::empty_slot;
+
+template<typename Value, std::size_t Slots>
+std::size_t perfect_hash_map<Value, Slots>::slot_for(string_view key,
+                                                     std::uint32_t seed) {
+	//FNV-1a with the seed folded into the basis, then a final mix
+	std::uint32_t h=2166136261u ^ seed;
+	for(unsigned char c : key) {
+		h^=c;
+		h*=16777619u;
+	}
+	h^=h >> 15;
+	h*=0x2c1b3c6du;
+	h^=h >> 12;
+	return h & (Slots-1);
+}
+
+template<typename Value, std::size_t Slots>
+bool perfect_hash_map<Value, Slots>::try_seed(std::uint32_t seed) {
+	slots_.fill(empty_slot);
+	for(std::size_t i=0; i!=entries_.size(); ++i) {
+		auto& slot=slots_[slot_for(entries_[i].key, seed)];
+		if(slot != empty_slot) return false;
+		slot=static_cast<index_type>(i);
+	}
+	seed_=seed;
+	return true;
+}
+
+template<typename Value, std::size_t Slots>
+perfect_hash_map<Value, Slots>::perfect_hash_map(
+		std::initializer_list<entry> entries)
+:	perfect_hash_map ( std::vector<entry>(entries) )
+{	}
+
+template<typename Value, std::size_t Slots>
+perfect_hash_map<Value, Slots>::perfect_hash_map(std::vector<entry> entries)
+:	entries_ ( std::move(entries) )
+{
+	if(entries_.size() >= empty_slot || entries_.size() > Slots)
+		throw std::logic_error("perfect_hash_map: too many keys");
+
+	for(std::uint32_t seed=0; seed!=1000000; ++seed) {
+		if(try_seed(seed)) return;
+	}
+	throw std::logic_error("perfect_hash_map: no perfect seed, increase Slots");
+}
+
+template<typename Value, std::size_t Slots>
+const Value* perfect_hash_map<Value, Slots>::find(string_view key) const {
+	auto i=slots_[slot_for(key, seed_)];
+	if(i == empty_slot) return nullptr;
+
+	const auto& e=entries_[i];
+	return key == e.key ? &e.value : nullptr;
+}
+
+template<typename Value, std::size_t Slots>
+std::size_t perfect_hash_map<Value, Slots>::size() const {
+	return entries_.size();
+}
+
+} //namespace irc
+
+#endif //IRC_PERFECT_HASH_HPP
@@ -2,8 +2,13 @@
 #define PERSISTANT_CONNECTION
 
 #include "types.hpp"
+#include "lazy_signal.hpp"
+#include "flood_control.hpp"
+#include "reconnect_backoff.hpp"
 
 #include <boost/asio/io_service.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/optional.hpp>
 
 #include <string>
 #include <vector>
@@ -13,27 +18,92 @@ namespace irc {
 
 namespace ba=boost::asio;
 
+/**
+ * A server to connect to
+ */
+struct server_endpoint {
+	std::string hostname;
+	std::string service;
+}; //struct server_endpoint
+
 /**
  * A connection which will reconnect on fatal error
+ *
+ * Each reconnect moves on to the next server in the list, waiting as
+ * the reconnect_policy says. The wait starts over once a connection
+ * has stayed established for a while.
+ *
+ * With hot standby on a second socket is kept connected to the next
+ * server, a failure promotes it in place of resolving and connecting
+ * again. It is not registered, on_connect is emitted for it like any
+ * new connection so the owner registers it. Servers drop unregistered
+ * clients after a while so it is reopened whenever it is lost, waiting
+ * longer each time as the reconnect_policy says.
  */
 class persistant_connection {
+public:
+	using clock     =reconnect_backoff::clock;
+	using time_point=clock::time_point;
+	using duration  =clock::duration;
+private:
+	//lines a standby may hold before promotion, servers only send a
+	//few notices to an unregistered client
+	static constexpr std::size_t max_standby_lines=64;
+
 	ba::io_service&                    io_service_;
-	std::string                        hostname_,
-	                                   service_;
+	//timer handlers hold a weak_ptr, it expires when we are destroyed
+	std::shared_ptr<bool>              alive_ { std::make_shared<bool>(true) };
+	std::vector<server_endpoint>       servers_;
+	std::size_t                        server_index_ { 0 };
 	std::shared_ptr<simple_connection> connection_;
 	//TODO: add unique_connection to util and use that
-	std::vector<bsig::connection>      callbacks_;
+	std::vector<signal_connection>     callbacks_;
+	flood_control                      flood_control_;
+	ba::steady_timer                   flood_timer_;
+	bool                               flood_timer_armed_ { false };
+	read_handler                       read_handler_;
+	bool                               reading_      { false },
+	                                   read_started_ { false };
+	reconnect_backoff                  backoff_;
+	ba::steady_timer                   reconnect_timer_;
+	boost::optional<time_point>        next_reconnect_;
+	boost::optional<time_point>        failed_at_;
+	boost::optional<time_point>        connected_at_;
+	bool                               hold_until_established_ { false },
+	                                   established_            { false };
+	boost::optional<duration>          last_failover_;
+
+	bool                               hot_standby_   { false };
+	std::shared_ptr<simple_connection> standby_;
+	std::size_t                        standby_index_ { 0 };
+	bool                               standby_ready_ { false };
+	//losing standbys over and over is backed off from like reconnects
+	reconnect_backoff                  standby_backoff_;
+	std::vector<signal_connection>     standby_callbacks_;
+	std::vector<std::string>           standby_lines_;
+	ba::steady_timer                   standby_timer_;
 
 	//perhaps these could be std::functions rather than bsigs
-	sig_s on_resolve;
-	sig_s on_connect;
-	sig_s on_disconnect;
-	sig_s on_read;
+	sig_s               on_resolve;
+	sig_s               on_connect;
+	sig_s               on_disconnect;
+	lazy_signal<sig_sv> on_read;
+	lazy_signal<sig_v>  on_give_up;
 
 	void failure_handler(const std::string& str);
 	void schedule_reconnect();
 	void initiate_connection();
+	void attach_connection();
+	void handle_connected();
 	void clear_callbacks();
+	void flush_writes();
+	void schedule_flush(flood_control::duration delay);
+	void clear_writes();
+	void cancel_reconnect();
+	void open_standby();
+	void close_standby();
+	void standby_failed();
+	void promote_standby();
 public:
 	/**
 	 * constructor for persistant_connection
@@ -44,16 +114,30 @@ public:
 	 */
 	persistant_connection(ba::io_service& io_service,
 		std::string hostname, std::string service);
+	/**
+	 * constructor for persistant_connection
+	 *
+	 * @param io_service the io_service to use
+	 * @param servers to connect to, tried in turn starting from the first
+	 * @param policy how to space out reconnection attempts
+	 *
+	 * @throws irc::exception if servers is empty
+	 */
+	persistant_connection(ba::io_service& io_service,
+		std::vector<server_endpoint> servers,
+		reconnect_policy policy=reconnect_policy { });
 	/**
 	 * destructor for persistant_connection
 	 */
 	~persistant_connection();
 	/**
-	 * gets the hostname the connection is connected to
+	 * gets the hostname the connection is connected to,
+	 * or the next one to be tried while reconnecting
 	 *
 	 * returns the hostname
 	 */
 	const std::string get_hostname() const;
+	ba::io_service& get_io_service() const;
 	/**
 	 * gets the service the connection is connected to,
 	 * in most cases this is the port as a string. ie "6667"
@@ -61,10 +145,69 @@ public:
 	 * returns the service
 	 */
 	const std::string get_service() const;
+	/**
+	 * returns the servers tried in turn on reconnect
+	 */
+	const std::vector<server_endpoint>& get_servers() const;
+	/**
+	 * sets how reconnection attempts are spaced out,
+	 * takes effect from the next attempt
+	 */
+	void set_reconnect_policy(reconnect_policy policy);
+	/**
+	 * returns how reconnection attempts are spaced out
+	 */
+	const reconnect_policy& get_reconnect_policy() const;
+	/**
+	 * returns the number of reconnection attempts since the last
+	 * connection which stayed established for the policy's stable_after
+	 */
+	std::size_t get_reconnect_attempts() const;
+	/**
+	 * returns when the next reconnection attempt will be made,
+	 * empty unless one is waiting
+	 */
+	boost::optional<time_point> get_next_reconnect() const;
+	/**
+	 * holds back everything but urgent writes on each new connection
+	 * until mark_established(), for protocols which register first.
+	 * Otherwise a connection is established as soon as it connects.
+	 */
+	void set_hold_until_established(bool hold);
+	/**
+	 * called by the owner once the server has accepted us, this ends an
+	 * outage for get_last_failover_time() and releases held writes
+	 */
+	void mark_established();
+	/**
+	 * returns whether the current connection is established
+	 */
+	bool is_established() const;
+	/**
+	 * keeps a standby connection to promote on failure, see above
+	 *
+	 * This costs a second socket per connection, and servers drop it at
+	 * their registration timeout. It is then reopened after a backoff
+	 * that grows with each loss until it is promoted, or given up on
+	 * after max_attempts losses. Until then each connection still opens
+	 * a new one every max_delay plus that timeout, across many
+	 * connections to one network raise max_delay or leave this off.
+	 */
+	void set_hot_standby(bool enabled);
+	bool get_hot_standby() const;
+	/**
+	 * returns whether a standby is connected and ready to be promoted
+	 */
+	bool has_standby() const;
+	/**
+	 * returns how long the last failure left us without a connection,
+	 * from the error to the replacement being established,
+	 * empty if there has not been one
+	 */
+	boost::optional<duration> get_last_failover_time() const;
 	/**
 	 * The connection is ready to be written to,
-	 * if this is false and you attempt to write
-	 * then an exception will be thrown
+	 * while this is false writes wait in the queue
 	 *
 	 * return whether or not the connection is ready
 	 */
@@ -74,38 +217,77 @@ public:
 	/**
 	 * writes the string to the connection
 	 *
+	 * the message is queued behind any waiting messages of the same
+	 * or higher priority and sent once the flood limits allow,
+	 * and once connected if still connecting
+	 *
 	 * @param str the message to be written
+	 * @param priority the lane to queue the message in
 	 *
-	 * @throws irc::exception is throw is connection is !is_ready()
+	 * @throws irc::exception if the connection has failed
+	 */
+	void write(std::string str,
+	           write_priority priority=write_priority::normal);
+	/**
+	 * sets the outbound flood limits
+	 */
+	void set_flood_limits(flood_limits limits);
+	/**
+	 * returns the outbound flood limits
+	 */
+	const flood_limits& get_flood_limits() const;
+	/**
+	 * returns the number of messages waiting on the flood limits
 	 */
-	void write(std::string str);
+	std::size_t get_queue_depth() const;
+	/**
+	 * returns the estimated time until every waiting message is sent
+	 */
+	flood_control::duration get_expected_drain_time() const;
 
+	/**
+	 * starts reading, connections made after a failure then
+	 * start reading as soon as they are connected
+	 */
 	void start_read();
+	/**
+	 * sets the handler each line read is passed to, straight from the
+	 * socket without a signal, on_read remains for other observers
+	 */
+	void set_read_handler(read_handler handler);
 
 	void stop();
 
-	template<typename F> bsig::connection connect_on_resolve(F&& f);
-	template<typename F> bsig::connection connect_on_connect(F&& f);
-	template<typename F> bsig::connection connect_on_disconnect(F&& f);
-	template<typename F> bsig::connection connect_on_read(F&& f);
+	template<typename F> signal_connection connect_on_resolve(F&& f);
+	template<typename F> signal_connection connect_on_connect(F&& f);
+	template<typename F> signal_connection connect_on_disconnect(F&& f);
+	template<typename F> signal_connection connect_on_read(F&& f);
+	/**
+	 * called once max_attempts reconnects have failed, no more are made
+	 */
+	template<typename F> signal_connection connect_on_give_up(F&& f);
 }; //class persistant_connection
 
 template<typename F>
-bsig::connection persistant_connection::connect_on_resolve(F&& f) {
+signal_connection persistant_connection::connect_on_resolve(F&& f) {
 	return on_resolve.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection persistant_connection::connect_on_connect(F&& f) {
+signal_connection persistant_connection::connect_on_connect(F&& f) {
 	return on_connect.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection persistant_connection::connect_on_disconnect(F&& f) {
+signal_connection persistant_connection::connect_on_disconnect(F&& f) {
 	return on_disconnect.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection persistant_connection::connect_on_read(F&& f) {
+signal_connection persistant_connection::connect_on_read(F&& f) {
 	return on_read.connect(std::forward<F>(f));
 }
+template<typename F>
+signal_connection persistant_connection::connect_on_give_up(F&& f) {
+	return on_give_up.connect(std::forward<F>(f));
+}
 
 
 
@@ -9,6 +9,7 @@
 
 #include "types.hpp"
 
+#include <cstdint>
 #include <ostream>
 #include <string>
 
@@ -17,30 +18,45 @@ namespace irc {
     @ref irc::message prefix.
     Represented by either a server's hostname, e.g. irc.freenode.net,
     or an user hostmask, with the format nickname!username\@hostname.
+
+    The parts are kept back to back in one string, so a prefix costs at
+    most a single allocation.
 */
-struct prefix { 
-	optional_string nick, user, host; 
+class prefix {
+	std::string   buffer_;
+	std::uint16_t user_pos_ { 0 },
+	              host_pos_ { 0 };
+	std::uint8_t  parts_    { 0 };
+
+	void assign(const optional_string_view& nick_,
+	            const optional_string_view& user_,
+	            const optional_string_view& host_);
+	optional_string_view part(std::uint8_t bit,
+	                          std::size_t first, std::size_t last) const;
+public:
 /**
     Constructor.
     @param nick_ User nickname.
     @param user_ User name.
     @param host_ User hostname.
 */
-	prefix(optional_string nick_,
-	       optional_string user_, 
-	       optional_string host_);
+	prefix(const optional_string& nick_,
+	       const optional_string& user_,
+	       const optional_string& host_);
 /**
     Constructor.
     @param nick_ User nickname.
 */
-	prefix(optional_string nick_);
-
+	prefix(const optional_string& nick_);
+/**
+    Copies the parts of a parsed prefix.
+    @param pfx The parts, they need not outlive the prefix.
+*/
+	explicit prefix(const prefix_view& pfx);
 /** Default constructor. */
 	prefix()                        =default;
-
 /** Copy constructor. */
 	prefix(prefix&&)                =default;
-
 /** Copy constructor. */
 	prefix(const prefix&)           =default;
 /**
@@ -53,7 +69,20 @@ struct prefix {
     @return Prefix reference.
 */
 	prefix& operator=(const prefix&)=default;
-};
+
+/**
+    @return The nickname, if any, valid until the prefix is modified.
+*/
+	optional_string_view nick() const;
+/**
+    @return The user name, if any, valid until the prefix is modified.
+*/
+	optional_string_view user() const;
+/**
+    @return The hostname, if any, valid until the prefix is modified.
+*/
+	optional_string_view host() const;
+}; //class prefix
 
 std::ostream& operator<<(std::ostream& os, const prefix& pfx);
 
@@ -0,0 +1,80 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_RECONNECT_BACKOFF_HPP
+#define IRC_RECONNECT_BACKOFF_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+
+namespace irc {
+
+/**
+ * How long to wait between attempts to reconnect. The first retry waits
+ * first_delay plus a random part of first_spread, each one after waits
+ * multiplier times longer than the last, starting at base_delay and
+ * never more than max_delay.
+ *
+ * Up to jitter (a fraction) of each later delay is taken off at random,
+ * so many clients dropped at once don't all return at once.
+ * A zero max_attempts retries forever.
+ *
+ * The curve only starts over once a connection has lasted stable_after,
+ * a server which accepts and then drops us keeps being backed off from.
+ */
+struct reconnect_policy {
+	std::chrono::milliseconds first_delay  { 0 };
+	std::chrono::milliseconds first_spread { 2000 };
+	std::chrono::milliseconds base_delay   { 5000 };
+	double                    multiplier   { 2.0 };
+	std::chrono::milliseconds max_delay    { 60000 };
+	double                    jitter       { 0.25 };
+	std::size_t               max_attempts { 0 };
+	std::chrono::milliseconds stable_after { 30000 };
+}; //struct reconnect_policy
+
+/**
+ * Counts reconnection attempts and spaces them out by a reconnect_policy
+ */
+class reconnect_backoff {
+public:
+	using clock   =std::chrono::steady_clock;
+	using duration=clock::duration;
+private:
+	reconnect_policy policy_;
+	std::size_t      attempts_ { 0 };
+	std::minstd_rand random_;
+public:
+	/**
+	 * @param policy the curve to follow
+	 * @param seed   for the jitter
+	 */
+	explicit reconnect_backoff(reconnect_policy policy=reconnect_policy { },
+	                           unsigned seed=std::random_device { }());
+
+	/**
+	 * Counts an attempt.
+	 * @return how long to wait before making it
+	 */
+	duration    next_delay();
+	/**
+	 * @return true once max_attempts have been made
+	 */
+	bool        exhausted() const;
+	/**
+	 * Starts the curve again, call once a connection has proved stable.
+	 */
+	void        reset();
+	std::size_t attempts() const;
+
+	void                    set_policy(reconnect_policy policy);
+	const reconnect_policy& get_policy() const;
+}; //class reconnect_backoff
+
+} //namespace irc
+
+#endif //IRC_RECONNECT_BACKOFF_HPP
@@ -7,16 +7,24 @@
 #ifndef SESSION_HPP
 #define SESSION_HPP
 
+#include "casemapping.hpp"
 #include "command.hpp"
 #include "deref.hpp"
+#include "flat_hash.hpp"
+#include "message.hpp"
+#include "message_tags.hpp"
+#include "modes.hpp"
+#include "mpsc_queue.hpp"
+#include "slab_pool.hpp"
 #include "types.hpp"
 
+#include <boost/asio/io_service.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
+#include <atomic>
 #include <memory> //shared_ptr
 #include <string>
 #include <vector>
-#include <unordered_map>
 
 namespace irc {
 
@@ -27,10 +35,10 @@ bool is_operator(const std::string& s);
 */
 class session {
 //member types
-	using channel_container                 =std::unordered_map<std::string, shared_channel>;
+	using channel_container                 =flat_hash_map<folded_key, shared_channel, folded_key_hash>;
 	using channel_iterator                  =channel_container::iterator;
 
-	using user_container                    =std::unordered_map<std::string, shared_user>;
+	using user_container                    =flat_hash_map<folded_key, shared_user, folded_key_hash>;
 	using user_iterator                     =user_container::iterator;
 
 	using const_user_iterator               =boost::transform_iterator<
@@ -41,12 +49,31 @@ class session {
 												second_deref,
 												channel_container::const_iterator
 											>;
+	struct pending_write {
+		std::string    line;
+		write_priority priority;
+	}; //struct pending_write
+	//lines queued by other threads, shared with write handles and the
+	//drain posted to the io_service so that they can tell if the session
+	//has gone
+	struct outbox {
+		mpsc_queue<pending_write> queue;
+		std::atomic<bool>         drain_posted { false };
+		std::atomic<session*>     owner { nullptr };
+	}; //struct outbox
 //member variables
-	bool                                     active_;
+	bool                                     active_ { false };
 	std::unique_ptr<persistant_connection>   connection_;
+	std::shared_ptr<slab_pool>               pool_;
 	channel_container                        channels_;
 	user_container                           users_;
 	std::string                              nickname_, username_, realname_, motd_;
+	message_tags                             current_tags_;
+	mode_classes                             mode_classes_;
+	casemapping                              casemapping_ { casemapping::rfc1459 };
+	mode_diff                                mode_diff_;
+	std::shared_ptr<outbox>                  outbox_;
+	std::vector<std::string>                 rejoin_;
 //callback
 	sig_s                                    on_motd;
 	sig_ch                                   on_join_channel;
@@ -58,11 +85,15 @@ class session {
 	sig_s                                    on_nick_change;
 	sig_rs_s                                 generate_new_nick;
 	sig_v                                    on_connection_established;
-	bsig::connection                         on_connect_handle;
+	signal_connection                        on_connect_handle;
 //helper
+	folded_key key_for(string_view name) const;
+	bool is_self(string_view nick) const;
+	void set_casemapping(casemapping cm);
 	void join_sequence();
 	void rejoin_sequence();
 	void prepare_connection();
+	void reset_state();
 	channel_iterator create_new_channel(const std::string& channel_name);
 	channel_iterator get_or_create_channel(const std::string& channel_name);
 
@@ -70,7 +101,10 @@ class session {
 	                              const prefix& pfx);
 	user_iterator get_or_create_user(const prefix& pfx);
 	user_iterator get_or_create_user(const std::string& nickname);
+	void forget_if_unshared(const shared_user& user);
 //handlers
+	void handle_line(string_view raw_msg);
+
 	void handle_privmsg(const prefix&                   pfx,
 	                    const std::string&              target,
 	                    const std::string&              content);
@@ -98,17 +132,21 @@ class session {
 
 	void handle_reply(  const prefix&                   pfx,
 	                    command                         cmd,
-	                    const std::vector<std::string>& params);
+	                    const param_list&              params);
 
 	void handle_mode(   const prefix&                   pfx,
-	                    const std::string&              agent,
-	                    const std::string&              mode);
+	                    const param_list&              params);
+
+	void handle_isupport(const param_list& params);
 
 	void handle_nick(   const prefix&                   pfx,
 	                    const std::string&              new_nick);
 
 	void handle_nick_in_use();
 	void handle_connection_established();
+	static void post_drain(const std::shared_ptr<outbox>& box,
+	                       boost::asio::io_service& io_service);
+	void drain_outbox();
 //deleted functions
 	session(const session&)           =delete;
 	session(session&&)                =delete;
@@ -124,6 +162,10 @@ public:
 	 */
 	session(std::unique_ptr<persistant_connection>&& conn,
 	        std::string nickname, std::string username, std::string realname);
+	/**
+	 * Destructor, drops anything still queued by post_write().
+	 */
+	~session();
 
 
 	//TODO
@@ -147,6 +189,26 @@ public:
 	 * @see get_self()
 	 */
 	const user& get_self() const;
+	/**
+	 * Returns the IRCv3 tags of the message currently being handled,
+	 * eg server-time, msgid or account.
+	 * The tags refer into the read buffer so they are only valid
+	 * inside a signal handler, copy any value you need to keep.
+	 * @return The tags, empty outside of a handler.
+	 */
+	const message_tags& get_current_tags() const;
+	/**
+	 * Returns the channel mode types, as advertised by the server
+	 * in RPL_ISUPPORT, or the RFC 2811 set before that.
+	 * @return The channel mode types.
+	 */
+	const mode_classes& get_mode_classes() const;
+	/**
+	 * Returns how the server compares nicks and channel names,
+	 * as advertised in RPL_ISUPPORT, or rfc1459 before that.
+	 * @return The casemapping.
+	 */
+	casemapping get_casemapping() const;
 	/**
 	 * Returns a const iterator to the beginning of the user list.
 	 * @return A const iterator to the beginning of the user list.
@@ -183,8 +245,11 @@ public:
 	 * Sends a message to the specified target.
 	 * @param target The target where to send the message, a channel or a nickname.
 	 * @param msg    The message to send.
+	 * @param priority The outbound lane, use write_priority::bulk for
+	 *                 mass output that may wait behind everything else.
 	 */
-	void async_privmsg(const std::string& target, const std::string& msg);
+	void async_privmsg(const std::string& target, const std::string& msg,
+	                   write_priority priority=write_priority::normal);
 	/**
 	 * Invites a user to join a channel
 	 * @param channel_name the name of the channel you are inviting the user to
@@ -201,17 +266,66 @@ public:
 	 * Closes the connection.
 	 */
 	void stop(); //async_stop?
+
+//thread safe interface
+	/**
+	 * Queues lines to be written on a session's own thread, from any
+	 * thread. It holds the session's outbox rather than the session, so
+	 * it may be copied freely and outlive the session, lines posted once
+	 * the session is destroyed are dropped. It must not outlive the
+	 * io_service the session ran on.
+	 */
+	class write_handle {
+		std::shared_ptr<outbox>  outbox_;
+		boost::asio::io_service* io_service_;
+
+		friend class session;
+		write_handle(std::shared_ptr<outbox> box,
+		             boost::asio::io_service& io_service);
+	public:
+		/**
+		 * Queues a raw line, never blocks, lines are written in the
+		 * order they were queued.
+		 * @param line     The complete line, including "\r\n".
+		 * @param priority The outbound lane.
+		 */
+		void post_write(std::string line,
+		                write_priority priority=write_priority::normal);
+		/**
+		 * Thread safe version of async_privmsg().
+		 * @see post_write()
+		 */
+		void post_privmsg(const std::string& target, const std::string& msg,
+		                  write_priority priority=write_priority::normal);
+	}; //class write_handle
+	/**
+	 * Gets a handle to pass to other threads, call on the session's
+	 * own thread, e.g. from session_host::post().
+	 */
+	write_handle get_write_handle() const;
+	/**
+	 * Same as get_write_handle().post_write(), only for threads which
+	 * know the session is still alive.
+	 */
+	void post_write(std::string line,
+	                write_priority priority=write_priority::normal);
+	/**
+	 * Same as get_write_handle().post_privmsg(), only for threads which
+	 * know the session is still alive.
+	 */
+	void post_privmsg(const std::string& target, const std::string& msg,
+	                  write_priority priority=write_priority::normal);
 	/**
 	 * Connect to the on_motd signal.
 	 * This signal is triggered when receiving the Message Of The Day
 	 * from the IRC server.
 	 *
 	 * @param f A callback function with the following signature:
-	 * @code void f(std::string msg) @endcode
+	 * @code void f(const std::string& msg) @endcode
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_motd(F&& f);
+	template<typename F> signal_connection connect_on_motd(F&& f);
 	/**
 	 * Connect to the on_join_channel signal.
 	 * This signal is triggered when an user joins an IRC channel.
@@ -221,17 +335,17 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_join_channel(F&& f);
+	template<typename F> signal_connection connect_on_join_channel(F&& f);
 	/**
 	 * Connect to the on_notice signal.
 	 * This signal is triggered when an irc::command::notice was sent.
 	 *
 	 * @param f A callback function with the following signature:
-	 * @code void f(std::string msg) @endcode
+	 * @code void f(const std::string& msg) @endcode
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_notice(F&& f);
+	template<typename F> signal_connection connect_on_notice(F&& f);
 	/**
 	 * Connect to the on_user_notice signal.
 	 * This signal is triggered when an irc::command::notice was sent
@@ -242,7 +356,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_user_notice(F&& f);
+	template<typename F> signal_connection connect_on_user_notice(F&& f);
 	/**
 	 * Connect to the on_new_user signal
 	 * this signal is triggered when ever a new user is "known" to the system
@@ -263,7 +377,7 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_new_user(F&& f);
+	template<typename F> signal_connection connect_on_new_user(F&& f);
 	/**
 	 * Connect to the on_irc_error
 	 * This signal is triggered when ever the server has replied
@@ -282,52 +396,52 @@ public:
 	 *
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_irc_error(F&& f);
+	template<typename F> signal_connection connect_on_irc_error(F&& f);
 
-	template<typename F> bsig::connection connect_on_nick_change(F&& f);
-	template<typename F> bsig::connection connect_generate_new_nick(F&& f);
-	template<typename F> bsig::connection connect_on_connection_established(F&& f);
+	template<typename F> signal_connection connect_on_nick_change(F&& f);
+	template<typename F> signal_connection connect_generate_new_nick(F&& f);
+	template<typename F> signal_connection connect_on_connection_established(F&& f);
 }; //class session
 
 
 template<typename F>
-bsig::connection session::connect_on_motd(F&& f) {
+signal_connection session::connect_on_motd(F&& f) {
 	return on_motd.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection session::connect_on_join_channel(F&& f) {
+signal_connection session::connect_on_join_channel(F&& f) {
 	return on_join_channel.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection session::connect_on_notice(F&& f) {
+signal_connection session::connect_on_notice(F&& f) {
 	return on_notice.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection session::connect_on_user_notice(F&& f) {
+signal_connection session::connect_on_user_notice(F&& f) {
 	return on_user_notice.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection session::connect_on_new_user(F&& f) {
+signal_connection session::connect_on_new_user(F&& f) {
 	return on_new_user.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection session::connect_on_irc_error(F&& f) {
+signal_connection session::connect_on_irc_error(F&& f) {
 	return on_irc_error.connect(std::forward<F>(f));
 }
 
 template<typename F>
-bsig::connection session::connect_on_nick_change(F&& f) {
+signal_connection session::connect_on_nick_change(F&& f) {
 	return on_nick_change.connect(std::forward<F>(f));
 }
 
 template<typename F>
-bsig::connection session::connect_generate_new_nick(F&& f) {
+signal_connection session::connect_generate_new_nick(F&& f) {
 	generate_new_nick.disconnect_all_slots();
 	return generate_new_nick.connect(std::forward<F>(f));
 }
 
 template<typename F>
-bsig::connection session::connect_on_connection_established(F&& f) {
+signal_connection session::connect_on_connection_established(F&& f) {
 	return on_connection_established.connect(std::forward<F>(f));
 }
 
@@ -0,0 +1,109 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_SESSION_HOST_HPP
+#define IRC_SESSION_HOST_HPP
+
+#include "flat_hash.hpp"
+#include "types.hpp"
+
+#include <boost/asio/io_service.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace irc {
+
+namespace ba=boost::asio;
+
+/**
+ * Runs many sessions across a pool of threads
+ *
+ * Each thread runs its own io_service, a session and its connection
+ * live on one of them for their whole life and are only ever touched
+ * from that thread, so a session still needs no locking. New sessions
+ * go to the thread currently hosting the fewest.
+ *
+ * Every call may be made from any thread.
+ */
+class session_host {
+public:
+	/**
+	 * Builds a session on the io_service it is passed, called on the
+	 * thread that will host it.
+	 */
+	using session_factory=std::function<std::unique_ptr<session>(ba::io_service&)>;
+	using session_id     =std::size_t;
+
+	struct thread_stats {
+		std::size_t   sessions; //hosted, or about to be
+		std::uint64_t handlers; //completion handlers run
+		std::uint64_t errors;   //exceptions which escaped a handler
+	}; //struct thread_stats
+private:
+	struct worker {
+		ba::io_service                                         io_service;
+		std::unique_ptr<ba::io_service::work>                  work;
+		//only touched on the worker's own thread
+		flat_hash_map<session_id, std::unique_ptr<session>>    sessions;
+		std::atomic<std::size_t>                               session_count { 0 };
+		std::atomic<std::uint64_t>                             handlers      { 0 };
+		std::atomic<std::uint64_t>                             errors        { 0 };
+		std::thread                                            thread;
+	}; //struct worker
+
+	std::vector<std::unique_ptr<worker>> workers_;
+	std::atomic<std::size_t>             next_serial_ { 0 };
+
+	static void run(worker& w);
+	worker&     worker_for(session_id id);
+
+	session_host(const session_host&)           =delete;
+	session_host& operator=(const session_host&)=delete;
+public:
+	/**
+	 * Starts the threads.
+	 * @param threads how many, 0 for one per core
+	 */
+	explicit session_host(std::size_t threads=0);
+	/**
+	 * Destroys every session on its own thread then joins the threads.
+	 */
+	~session_host();
+
+	/**
+	 * Creates a session on the least loaded thread, the factory runs
+	 * asynchronously on that thread.
+	 * @return the id to refer to the session by
+	 */
+	session_id add_session(session_factory make);
+	/**
+	 * Destroys a session on its thread, does nothing if it's unknown.
+	 */
+	void remove_session(session_id id);
+	/**
+	 * Runs f with the session on its thread, this is the only safe way
+	 * to reach a hosted session. Dropped if the session is unknown.
+	 * Other threads which write to it should take a
+	 * session::write_handle from here rather than keep the session,
+	 * it may be removed at any time.
+	 */
+	void post(session_id id, std::function<void(session&)> f);
+
+	std::size_t               get_thread_count() const;
+	/**
+	 * @return a snapshot of each thread's load, in thread order
+	 */
+	std::vector<thread_stats> get_stats() const;
+}; //class session_host
+
+} //namespace irc
+
+#endif //IRC_SESSION_HOST_HPP
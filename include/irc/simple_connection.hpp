@@ -2,14 +2,16 @@
 #define IRC_SIMPLE_CONNECTION_HPP
 
 #include "types.hpp"
+#include "handler_allocator.hpp"
+#include "lazy_signal.hpp"
+#include "line_buffer.hpp"
+#include "write_queue.hpp"
 
 #include <boost/asio/io_service.hpp>
-#include <boost/asio/streambuf.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 #include <memory>
 #include <string>
-#include <deque>
 
 namespace irc {
 
@@ -21,23 +23,36 @@ namespace ba=boost::asio;
  */
 class simple_connection :
 		public std::enable_shared_from_this<simple_connection> {
-	using message_buffer =std::deque<std::string>;
-
 	bool                  active_ { false };
-	message_buffer        message_buffer_;
+	write_queue           write_queue_;
 	ba::io_service&       io_service_;
 	ba::ip::tcp::resolver resolver_;
 	ba::ip::tcp::socket   socket_;
-	ba::streambuf         streambuf_;
-
-	sig_s on_resolve;
-	sig_s on_connect;
-	sig_s on_error;
-	sig_s on_read;
-
-	const std::string     delim_ { "\r\n" };
-
-
+	line_buffer           read_buffer_;
+	read_handler          read_handler_;
+	//a handler set while lines are being dispatched waits here so the
+	//running one isn't destroyed under itself
+	read_handler          pending_handler_;
+	bool                  dispatching_     { false },
+	                      handler_pending_ { false };
+	//held while any handler carries an op_guard so the handlers can use this
+	std::shared_ptr<simple_connection> self_;
+	unsigned              pending_ { 0 };
+	handler_memory        resolve_memory_,
+	                      read_memory_,
+	                      write_memory_;
+
+	sig_s               on_resolve;
+	sig_s               on_connect;
+	sig_s               on_error;
+	lazy_signal<sig_sv> on_read;
+
+	class op_guard;
+	struct dispatch_scope;
+	void begin_op();
+	void end_op();
+
+	void apply_pending_handler();
 	void initiate_read();
 	void initiate_write();
 
@@ -58,28 +73,37 @@ public:
 	void start_read();
 
 	bool is_ready() const;
+	/**
+	 * sets the most bytes of queued messages sent in a single write
+	 */
+	void set_max_write_bytes(std::size_t max_bytes);
+	/**
+	 * sets the handler each line read is passed to, ahead of on_read,
+	 * this is how the owner of the connection receives lines
+	 */
+	void set_read_handler(read_handler handler);
 
 	//This might be better as std::function?
-	template<typename F> bsig::connection connect_on_resolve(F&& f);
-	template<typename F> bsig::connection connect_on_connect(F&& f);
-	template<typename F> bsig::connection connect_on_error(F&& f);
-	template<typename F> bsig::connection connect_on_read(F&& f);
+	template<typename F> signal_connection connect_on_resolve(F&& f);
+	template<typename F> signal_connection connect_on_connect(F&& f);
+	template<typename F> signal_connection connect_on_error(F&& f);
+	template<typename F> signal_connection connect_on_read(F&& f);
 }; //class simple_session
 
 template<typename F>
-bsig::connection simple_connection::connect_on_resolve(F&& f) {
+signal_connection simple_connection::connect_on_resolve(F&& f) {
 	return on_resolve.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection simple_connection::connect_on_connect(F&& f) {
+signal_connection simple_connection::connect_on_connect(F&& f) {
 	return on_connect.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection simple_connection::connect_on_error(F&& f) {
+signal_connection simple_connection::connect_on_error(F&& f) {
 	return on_error.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection simple_connection::connect_on_read(F&& f) {
+signal_connection simple_connection::connect_on_read(F&& f) {
 	return on_read.connect(std::forward<F>(f));
 }
 
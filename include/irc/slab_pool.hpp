@@ -0,0 +1,121 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_SLAB_POOL_HPP
+#define IRC_SLAB_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace irc {
+
+/**
+ * Fixed size block allocator
+ *
+ * Memory is taken from the heap a slab at a time and carved into equal
+ * blocks, one free list per block size. Freed blocks go back on their
+ * list and are handed out again before a new slab is taken, so objects
+ * which come and go (users and channels as people join and part) stop
+ * reaching malloc once the pool has grown to the working set. Slabs are
+ * only returned when the pool is destroyed.
+ *
+ * Not thread safe, a pool belongs to a single session.
+ */
+class slab_pool {
+	struct free_block {
+		free_block* next;
+	};
+	struct size_class {
+		std::size_t size;
+		free_block* free;
+	};
+
+	std::vector<std::unique_ptr<char[]>> slabs_;
+	std::vector<size_class>              classes_;
+	std::size_t                          blocks_per_slab_;
+	std::size_t                          in_use_ { 0 };
+
+	size_class& get_class(std::size_t size);
+	void        add_slab(size_class& sc);
+public:
+	/**
+	 * @param blocks_per_slab how many blocks each heap allocation holds
+	 */
+	explicit slab_pool(std::size_t blocks_per_slab=64);
+
+	slab_pool(const slab_pool&)           =delete;
+	slab_pool& operator=(const slab_pool&)=delete;
+
+	/**
+	 * @return a block of at least size bytes, aligned for any
+	 *         fundamental type
+	 */
+	void* allocate(std::size_t size);
+	/**
+	 * returns a block to its free list
+	 * @param size the size it was allocated with
+	 */
+	void  deallocate(void* p, std::size_t size);
+
+	/**
+	 * @return the number of blocks handed out and not yet returned
+	 */
+	std::size_t in_use()     const;
+	/**
+	 * @return the number of slabs taken from the heap
+	 */
+	std::size_t slab_count() const;
+}; //class slab_pool
+
+/**
+ * Allocator handing out single objects from a slab_pool, for use with
+ * std::allocate_shared. Each copy shares ownership of the pool so it
+ * lives for as long as any object allocated from it.
+ * Arrays go to the global operator new.
+ */
+template<typename T>
+class slab_allocator {
+	template<typename> friend class slab_allocator;
+	std::shared_ptr<slab_pool> pool_;
+public:
+	using value_type=T;
+
+	explicit slab_allocator(std::shared_ptr<slab_pool> pool)
+	:	pool_ ( std::move(pool) )
+	{	}
+
+	template<typename U>
+	slab_allocator(const slab_allocator<U>& other)
+	:	pool_ ( other.pool_ )
+	{	}
+
+	T* allocate(std::size_t n) {
+		static_assert(alignof(T) <= alignof(std::max_align_t),
+			"slab_allocator does not support over aligned types");
+		if(n == 1) return static_cast<T*>(pool_->allocate(sizeof(T)));
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, std::size_t n) {
+		if(n == 1) pool_->deallocate(p, sizeof(T));
+		else       ::operator delete(p);
+	}
+
+	template<typename U>
+	bool operator==(const slab_allocator<U>& other) const {
+		return pool_ == other.pool_;
+	}
+	template<typename U>
+	bool operator!=(const slab_allocator<U>& other) const {
+		return pool_ != other.pool_;
+	}
+}; //class slab_allocator
+
+} //namespace irc
+
+#endif //IRC_SLAB_POOL_HPP
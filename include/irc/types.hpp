@@ -9,7 +9,11 @@
 
 #include <boost/optional.hpp>
 #include <boost/signals2.hpp>
+#include <boost/utility/string_view.hpp>
 
+#include "light_signal.hpp"
+
+#include <functional>
 #include <string>
 
 /**
@@ -23,11 +27,13 @@ namespace irc {
 	template<typename ImplType>
 	class crtp_user;
 
-	struct prefix;
+	class prefix;
 	class connection;
 	class user_impl;
 	class channel_impl;
 	struct message;
+	struct message_view;
+	struct prefix_view;
 	class session;
 	class mode_block;
 	struct mode_diff;
@@ -35,6 +41,15 @@ namespace irc {
 	class simple_connection;
 	class persistant_connection;
 
+	/**
+	 * The outbound lanes of persistant_connection, in the order they are served
+	 */
+	enum class write_priority : unsigned char {
+		urgent, //PONG and registration, never delayed
+		normal,
+		bulk
+	}; //enum class write_priority
+
 	using channel          =crtp_channel<channel_impl>;
 	using user             =crtp_user<user_impl>;
 
@@ -44,33 +59,58 @@ namespace irc {
 	using optional_string  =boost::optional<std::string>;
 	using optional_prefix  =boost::optional<prefix>;
 
+	using string_view      =boost::string_view;
+	using optional_string_view=boost::optional<string_view>;
+
 	using mode_entry       =std::pair<char, optional_string>;
 	using mode_list        =std::vector<mode_entry>;
 
-	using sig_p_2s         =bsig::signal<void(prefix, std::string, std::string)>;
-	using sig_s            =bsig::signal<void(std::string)>;
-	using sig_2s           =bsig::signal<void(std::string, std::string)>;
-	using sig_s_os         =bsig::signal<void(std::string, optional_string)>;
-	using sig_2s_os        =bsig::signal<void(std::string, std::string, optional_string)>;
-	using sig_p_vs_s       =bsig::signal<void(prefix, std::vector<std::string>, std::string)>;
-	using sig_p_s_os       =bsig::signal<void(prefix, std::string, optional_string)>;
-	using sig_ch           =bsig::signal<void(channel&)>;
-	using sig_p_s          =bsig::signal<void(const prefix&, const std::string&)>;
-	using sig_p_i_vs       =bsig::signal<void(prefix, int, std::vector<std::string>)>;
-	using sig_v            =bsig::signal<void(void)>;
-
-	using sig_usr          =bsig::signal<void(user&)>;
-	using sig_usr_s        =bsig::signal<void(user&, const std::string&)>;
-	using sig_ch           =bsig::signal<void(channel&)>;
-	using sig_ch_s         =bsig::signal<void(channel&, const std::string&)>;
-	using sig_ch_usr       =bsig::signal<void(channel&, user&)>;
-	using sig_ch_usr_s     =bsig::signal<void(channel&, user&, const std::string&)>;
-	using sig_ch_usr_os    =bsig::signal<void(channel&, user&, const optional_string&)>;
-
-	using sig_p_md         =bsig::signal<void(const prefix&, const mode_diff&)>;
-	using sig_ch_p_usr_md  =bsig::signal<void(irc::channel&, irc::user&, const prefix&, const mode_diff&)>;
+	/**
+	 * The signal type behind every sig_ alias. boost::signals2 by default,
+	 * define IRC_LIGHT_SIGNALS to use light_signal instead when each
+	 * session is only ever touched from one thread.
+	 */
+#ifdef IRC_LIGHT_SIGNALS
+	template<typename Signature>
+	using signal           =light_signal<Signature>;
+	using signal_connection=light_connection;
+#else
+	template<typename Signature>
+	using signal           =bsig::signal<Signature>;
+	using signal_connection=bsig::connection;
+#endif
+
+	using sig_p_2s         =signal<void(prefix, std::string, std::string)>;
+	using sig_s            =signal<void(const std::string&)>;
+	using sig_sv           =signal<void(string_view)>;
+	using sig_2s           =signal<void(std::string, std::string)>;
+	using sig_s_os         =signal<void(std::string, optional_string)>;
+	using sig_2s_os        =signal<void(std::string, std::string, optional_string)>;
+	using sig_p_vs_s       =signal<void(prefix, std::vector<std::string>, std::string)>;
+	using sig_p_s_os       =signal<void(prefix, std::string, optional_string)>;
+	using sig_ch           =signal<void(channel&)>;
+	using sig_p_s          =signal<void(const prefix&, const std::string&)>;
+	using sig_p_i_vs       =signal<void(prefix, int, std::vector<std::string>)>;
+	using sig_v            =signal<void(void)>;
+
+	using sig_usr          =signal<void(user&)>;
+	using sig_usr_s        =signal<void(user&, const std::string&)>;
+	using sig_ch           =signal<void(channel&)>;
+	using sig_ch_s         =signal<void(channel&, const std::string&)>;
+	using sig_ch_usr       =signal<void(channel&, user&)>;
+	using sig_ch_usr_s     =signal<void(channel&, user&, const std::string&)>;
+	using sig_ch_usr_os    =signal<void(channel&, user&, const optional_string&)>;
+
+	using sig_p_md         =signal<void(const prefix&, const mode_diff&)>;
+	using sig_ch_p_usr_md  =signal<void(irc::channel&, irc::user&, const prefix&, const mode_diff&)>;
 	//This could be moved?
-	using sig_rs_s         =bsig::signal<std::string(const std::string&)>;
+	using sig_rs_s         =signal<std::string(const std::string&)>;
+
+	/**
+	 * Where a connection hands each line it reads, called directly rather
+	 * than through a signal. The line is only valid for the call.
+	 */
+	using read_handler     =std::function<void(string_view)>;
 
 	using shared_prefix    =std::shared_ptr<prefix>;
 	using shared_channel   =std::shared_ptr<channel_impl>;
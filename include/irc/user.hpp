@@ -8,11 +8,13 @@
 #define IRC_USER_HPP
 
 #include "crtp_user.hpp"
+#include "lazy_signal.hpp"
 #include "types.hpp"
 #include "modes.hpp"
 #include "prefix.hpp"
 
 #include <string>
+#include <vector>
 
 namespace irc {
 
@@ -20,14 +22,18 @@ namespace irc {
  * The user class models and IRC user
  */
 class user_impl : public crtp_user<user_impl> {
+public:
+	using channel_list=std::vector<channel_impl*>;
+private:
 	std::string  nick_;
 	prefix       pfx_;
 	mode_block   modes_;
+	channel_list channels_;
 //signals
-	sig_ch_usr_s on_channel_message;
-	sig_usr_s    on_direct_message;
-	sig_usr_s    on_nick_change;
-	sig_usr_s    on_notice;
+	lazy_signal<sig_ch_usr_s> on_channel_message;
+	lazy_signal<sig_usr_s>    on_direct_message;
+	lazy_signal<sig_usr_s>    on_nick_change;
+	lazy_signal<sig_usr_s>    on_notice;
 
 //deleted functions
 	user_impl(const user_impl&)           =delete;
@@ -69,8 +75,23 @@ public:
 	 * @see get_modes
 	 */
 	const mode_block& get_modes_impl() const;
+	/**
+	 * @brief returns the channels this user is known to be in
+	 * @return the channels, in no particular order
+	 */
+	const channel_list& get_channels_impl() const;
 
 	//SYSTEM INTERFACE 
+	/**
+	 * Records that the user is a member of chan, kept in step by
+	 * channel_impl whenever its user list changes.
+	 */
+	void add_channel(channel_impl& chan);
+	/**
+	 * @see add_channel()
+	 */
+	void remove_channel(channel_impl& chan);
+
 	void set_nick(std::string nick_);
 	void set_prefix(prefix pfx_);
 
@@ -92,7 +113,7 @@ public:
 	 * @return the connection object to disconnect from the signal
 	 */
 	template<typename F>
-	bsig::connection connect_on_channel_message_impl(F&& f);
+	signal_connection connect_on_channel_message_impl(F&& f);
 	/**
 	 * @brief connect to the on_direct_message signal
 	 *
@@ -106,7 +127,7 @@ public:
 	 * @return the connection object to disconnect from the signal
 	 */
 	template<typename F>
-	bsig::connection connect_on_direct_message_impl(F&& f);
+	signal_connection connect_on_direct_message_impl(F&& f);
 	/**
 	 * @brief connect to the on_nick_change signal
 	 *
@@ -119,7 +140,7 @@ public:
 	 * @return the connection object to disconnect from the signal
 	 */	
 	template<typename F>
-	bsig::connection connect_on_nick_change_impl(F&& f);
+	signal_connection connect_on_nick_change_impl(F&& f);
 	/**
 	 * @brief connect to the on_notice signal
 	 *
@@ -132,7 +153,7 @@ public:
 	 * @return the connection object to disconnect from the signal
 	 */
 	template<typename F>
-	bsig::connection connect_on_notice_impl(F&& f);
+	signal_connection connect_on_notice_impl(F&& f);
 	/**
 	 * Connect to the on_set_change signal.
 	 * This signal is triggered when user's modes changed.
@@ -143,27 +164,27 @@ public:
 	 * @endcode
 	 * @return The connection object to disconnect from the signal.
 	 */
-	template<typename F> bsig::connection connect_on_mode_change_impl(F&& f);
+	template<typename F> signal_connection connect_on_mode_change_impl(F&& f);
 }; //class user_impl
 
 template<typename F>
-bsig::connection user_impl::connect_on_channel_message_impl(F&& f) {
+signal_connection user_impl::connect_on_channel_message_impl(F&& f) {
 	return on_channel_message.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection user_impl::connect_on_direct_message_impl(F&& f) {
+signal_connection user_impl::connect_on_direct_message_impl(F&& f) {
 	return on_direct_message.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection user_impl::connect_on_nick_change_impl(F&& f) {
+signal_connection user_impl::connect_on_nick_change_impl(F&& f) {
 	return on_nick_change.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection user_impl::connect_on_notice_impl(F&& f) {
+signal_connection user_impl::connect_on_notice_impl(F&& f) {
 	return on_notice.connect(std::forward<F>(f));
 }
 template<typename F>
-bsig::connection user_impl::connect_on_mode_change_impl(F&& f) {
+signal_connection user_impl::connect_on_mode_change_impl(F&& f) {
 	return modes_.connect_on_mode_change(
 		[=](const prefix& pfx, const mode_diff& md) {
 			f(*this, pfx, md);
@@ -0,0 +1,74 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_WRITE_QUEUE_HPP
+#define IRC_WRITE_QUEUE_HPP
+
+#include <boost/asio/buffer.hpp>
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace irc {
+
+/**
+ * Outbound message queue for a socket
+ *
+ * Rather than one write per message, every queued message (up to a cap
+ * in bytes) is handed to a single scatter/gather write.
+ */
+class write_queue {
+	using message_buffer=std::deque<std::string>;
+	using buffer_sequence=std::vector<boost::asio::const_buffer>;
+
+	message_buffer  messages_;
+	buffer_sequence buffers_;
+	std::size_t     in_flight_ { 0 };
+	std::size_t     max_bytes_;
+public:
+	static constexpr std::size_t default_max_bytes=16384;
+	/**
+	 * @param max_bytes the most bytes gathered into one write,
+	 * a single message larger than this is still written whole
+	 */
+	explicit write_queue(std::size_t max_bytes=default_max_bytes);
+	/**
+	 * queues a message
+	 *
+	 * @return true if no write is in flight and one should be started
+	 */
+	bool push(std::string msg);
+	/**
+	 * gathers the queued messages into a buffer sequence and marks
+	 * them as in flight, they stay alive until consume()
+	 *
+	 * @return the buffers to write, valid until the next prepare()
+	 */
+	const buffer_sequence& prepare();
+	/**
+	 * releases the messages of the completed write
+	 *
+	 * @return true if more messages are waiting to be written
+	 */
+	bool consume();
+	/**
+	 * drops all messages, including any in flight
+	 */
+	void clear();
+
+	bool        empty()     const;
+	std::size_t size()      const;
+	std::size_t in_flight() const;
+
+	void        set_max_bytes(std::size_t max_bytes);
+	std::size_t get_max_bytes() const;
+}; //class write_queue
+
+} //namespace irc
+
+#endif //IRC_WRITE_QUEUE_HPP
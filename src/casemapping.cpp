@@ -0,0 +1,116 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "casemapping.hpp"
+
+#include <cstdint>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace irc {
+
+namespace {
+
+//the last upper case character, folding adds 0x20 to 'A'..upper
+char upper_bound(casemapping cm) {
+	switch(cm) {
+	case casemapping::rfc1459:        return '^';
+	case casemapping::strict_rfc1459: return ']';
+	default:                          return 'Z';
+	}
+}
+
+//FNV-1a
+constexpr std::uint64_t fnv_basis=14695981039346656037ull;
+constexpr std::uint64_t fnv_prime=1099511628211ull;
+
+inline std::uint64_t hash_byte(std::uint64_t h, char c) {
+	return (h ^ static_cast<unsigned char>(c)) * fnv_prime;
+}
+
+//folds [first, last) into out and returns the hash of what was written
+std::uint64_t fold_and_hash(const char* first, const char* last,
+                            char* out, casemapping cm) {
+	const char upper=upper_bound(cm);
+	std::uint64_t h=fnv_basis;
+#ifdef __SSE2__
+	//bytes above 0x7f are negative so never fall inside 'A'..upper
+	const __m128i lo  =_mm_set1_epi8('A' - 1);
+	const __m128i hi  =_mm_set1_epi8(upper + 1);
+	const __m128i diff=_mm_set1_epi8(0x20);
+	for(; last-first >= 16; first+=16, out+=16) {
+		__m128i chunk=_mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+		__m128i is_upper=_mm_and_si128(_mm_cmpgt_epi8(chunk, lo),
+		                               _mm_cmpgt_epi8(hi, chunk));
+		chunk=_mm_add_epi8(chunk, _mm_and_si128(is_upper, diff));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), chunk);
+		for(int i=0; i!=16; ++i) h=hash_byte(h, out[i]);
+	}
+#endif
+	for(; first != last; ++first, ++out) {
+		char c=*first;
+		*out=c >= 'A' && c <= upper ? c + 0x20 : c;
+		h=hash_byte(h, *out);
+	}
+	return h;
+}
+
+} //namespace
+
+bool parse_casemapping(string_view value, casemapping& cm) {
+	if(value == "ascii")               cm=casemapping::ascii;
+	else if(value == "rfc1459")        cm=casemapping::rfc1459;
+	else if(value == "strict-rfc1459") cm=casemapping::strict_rfc1459;
+	else return false;
+	return true;
+}
+
+char fold_char(char c, casemapping cm) {
+	return c >= 'A' && c <= upper_bound(cm) ? c + 0x20 : c;
+}
+
+std::string fold_case(string_view s, casemapping cm) {
+	std::string out(s.size(), '\0');
+	if(!s.empty()) fold_and_hash(s.data(), s.data() + s.size(), &out[0], cm);
+	return out;
+}
+
+bool equal_folded(string_view a, string_view b, casemapping cm) {
+	if(a.size() != b.size()) return false;
+	for(std::size_t i=0; i!=a.size(); ++i) {
+		if(fold_char(a[i], cm) != fold_char(b[i], cm)) return false;
+	}
+	return true;
+}
+
+folded_key::folded_key(string_view name, casemapping cm)
+:	folded_ ( name.size(), '\0' )
+,	hash_   ( 0 )
+{
+	const char* first=name.data();
+	hash_=static_cast<std::size_t>(
+		fold_and_hash(first, first + name.size(), &folded_[0], cm));
+}
+
+const std::string& folded_key::str() const {
+	return folded_;
+}
+
+std::size_t folded_key::hash() const {
+	return hash_;
+}
+
+bool folded_key::operator==(const folded_key& other) const {
+	return hash_ == other.hash_ && folded_ == other.folded_;
+}
+
+bool folded_key::operator!=(const folded_key& other) const {
+	return !(*this == other);
+}
+
+} //namespace irc
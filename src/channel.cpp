@@ -19,10 +19,23 @@ channel_impl::channel_impl(session& session__, std::string name__)
 ,	name_    { std::move(name__) }
 {	}
 
+channel_impl::~channel_impl() {
+	clear_users();
+}
+
 
 bool channel_impl::is_nick_in_channel(const std::string& nick) const {
 	return std::find_if(begin_users(), end_users(), [&](const irc::user& u) { 
-		return u.get_nick() == nick; }) == end_users();
+		return u.get_nick() == nick; }) != end_users();
+}
+
+void channel_impl::erase_user(const shared_user& user) {
+	if(users_.erase(user)) user->remove_channel(*this);
+}
+
+void channel_impl::clear_users() {
+	for(const auto& user : users_) user->remove_channel(*this);
+	users_.clear();
 }
 
 /*
@@ -32,6 +45,7 @@ bool channel_impl::add_user(const shared_user& user) {
 	assert(user);
 	bool success;
 	std::tie(std::ignore, success)=users_.insert(user);
+	if(success) user->add_channel(*this);
 	return success;
 }
 
@@ -82,16 +96,17 @@ mode_block& channel_impl::get_modes_impl() { return modes_; }
 /*
 ** System interface
 */
-void channel_impl::apply_mode_diff(const prefix& pfx, mode_diff md) {
+void channel_impl::apply_mode_diff(const prefix& pfx, mode_diff& md) {
 	mode_list user_modes;
-	auto& ml=md.modes;
 
 	//separate user@channel modes
-	auto p=util::separate(ml.begin(), ml.end(), std::back_inserter(user_modes),
-		[&](const mode_block::value_type& v) {
-			return v.second && is_nick_in_channel(*v.second); }); 
+	for(auto* ml : { &md.set, &md.unset }) {
+		auto p=util::separate(ml->begin(), ml->end(), std::back_inserter(user_modes),
+			[&](const mode_block::value_type& v) {
+				return v.second && is_nick_in_channel(*v.second); }); 
 
-	ml.erase(p.first, ml.end());
+		ml->erase(p.first, ml->end());
+	}
 
 	modes_.apply_mode_diff(pfx, md);
 	//TODO handle user modes
@@ -108,12 +123,14 @@ void channel_impl::user_part(const shared_user& user, const optional_string& msg
 	auto it=users_.find(user);
 	if(it!=users_.cend()) {
 		on_user_part(*this, *user, msg);
-		users_.erase(it);
+		//handlers may have changed users_, don't reuse it
+		erase_user(user);
 	} //else was never actually regestered..
 }
 
 void channel_impl::part() {
 	on_channel_part(*this);
+	clear_users();
 	//DISCONNECT slots?
 }
 
@@ -128,8 +145,9 @@ void channel_impl::user_join(const shared_user& user) {
 void channel_impl::user_quit(const shared_user& user, const std::string& msg) {
 	auto it=users_.find(user);	
 	if(it!=users_.cend()) {
-		on_user_part(*this, **it, msg);
-		users_.erase(it);
+		on_user_part(*this, *user, msg);
+		//handlers may have changed users_, don't reuse it
+		erase_user(user);
 	}
 }
 
@@ -9,7 +9,6 @@
 #include "util.hpp"
 
 #include <boost/asio/connect.hpp>
-#include <boost/asio/read_until.hpp>
 #include <boost/asio/write.hpp>
 
 #include <functional>
@@ -61,10 +60,8 @@ void connection::async_resolve() {
 
 void connection::async_read() {
 	assert(state_==states::active);
-	boost::asio::async_read_until(
-		socket_,
-		streambuf_, 
-		delim_,
+	socket_.async_read_some(
+		read_buffer_.prepare(),
 		std::bind(
 			&connection::handle_read,
 			shared_from_this(),
@@ -77,7 +74,7 @@ void connection::async_write_next() {
 	assert(!write_buffer_.empty());
 	boost::asio::async_write(
 		socket_,
-		boost::asio::buffer(write_buffer_.front()),
+		write_buffer_.prepare(),
 		std::bind(
 			&connection::handle_write,
 			shared_from_this(),
@@ -87,20 +84,24 @@ void connection::async_write_next() {
 }
 
 void connection::async_write(std::string str) {
-	bool empty=write_buffer_.empty();
-	write_buffer_.push_back(std::move(str));
-	if(empty) async_write_next();
+	if(write_buffer_.push(std::move(str)))
+		async_write_next();
+}
+
+void connection::set_max_write_bytes(std::size_t max_bytes) {
+	write_buffer_.set_max_bytes(max_bytes);
 }
 
 void connection::handle_read(const boost::system::error_code& error,
 			                 std::size_t bytes_transferred) {
 	if(!error) {
-		std::istream is { &streambuf_ };
-		std::string msg;
-
-		if(std::getline(is, msg)) { //deplete the stream
-			on_read_msg(msg);
-		}
+		read_buffer_.commit(bytes_transferred);
+		read_buffer_.consume_lines(
+			[this](string_view line) {
+				on_read_msg(line);
+				return state_==states::active;
+			}
+		);
 
 		if(state_==states::active) {
 			async_read();
@@ -114,8 +115,7 @@ void connection::handle_read(const boost::system::error_code& error,
 void connection::handle_write(const boost::system::error_code& error,
                               std::size_t bytes_transferred) {
 	if(!error) {
-		write_buffer_.pop_front();
-		if(!write_buffer_.empty())
+		if(write_buffer_.consume())
 			async_write_next();
 	}
 	else {
@@ -0,0 +1,27 @@
+
+//          Copyright Joseph Dobson, Andrea Zanellato 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ctcp.hpp"
+#include "perfect_hash.hpp"
+
+namespace irc {
+namespace ctcp {
+
+command to_command(string_view tag) {
+	static const perfect_hash_map<command, 32> tags {
+		{ "ACTION",  command::action }, { "CLIENTINFO", command::clientinfo },
+		{ "DCC",     command::dcc    }, { "ERRMSG",     command::errmsg     },
+		{ "FINGER",  command::finger }, { "PING",       command::ping       },
+		{ "SED",     command::sed    }, { "SOURCE",     command::source     },
+		{ "TIME",    command::time   }, { "USERINFO",   command::userinfo   },
+		{ "VERSION", command::version }
+	};
+	auto found=tags.find(tag);
+	return found ? *found : command::none;
+}
+
+} //namespace ctcp
+} //namespace irc
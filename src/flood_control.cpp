@@ -0,0 +1,136 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "flood_control.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace irc {
+
+constexpr std::size_t flood_control::lane_count;
+
+namespace {
+
+//the tokens in a bucket after refilling for elapsed ticks
+double projected(double tokens, std::size_t capacity,
+                 double per_tick, flood_control::duration elapsed) {
+	if(elapsed.count() <= 0) return tokens;
+	return std::min<double>(capacity, tokens + elapsed.count() * per_tick);
+}
+
+//ticks until a bucket holds wanted tokens
+double ticks_until(double tokens, double wanted, double per_tick) {
+	return tokens >= wanted ? 0 : (wanted - tokens) / per_tick;
+}
+
+} //namespace
+
+flood_control::flood_control(flood_limits limits, time_point now)
+:	limits_      ( std::move(limits) )
+,	line_tokens_ ( limits_.lines     )
+,	byte_tokens_ ( limits_.bytes     )
+,	last_refill_ ( now               )
+{	}
+
+double flood_control::lines_per_tick() const {
+	auto ticks=std::chrono::duration_cast<duration>(limits_.window).count();
+	return ticks > 0 ? double(limits_.lines) / ticks : limits_.lines;
+}
+
+double flood_control::bytes_per_tick() const {
+	auto ticks=std::chrono::duration_cast<duration>(limits_.window).count();
+	return ticks > 0 ? double(limits_.bytes) / ticks : limits_.bytes;
+}
+
+void flood_control::refill(time_point now) {
+	auto elapsed=now - last_refill_;
+	line_tokens_=projected(line_tokens_, limits_.lines, lines_per_tick(), elapsed);
+	byte_tokens_=projected(byte_tokens_, limits_.bytes, bytes_per_tick(), elapsed);
+	last_refill_=std::max(now, last_refill_);
+}
+
+bool flood_control::can_send(write_priority p, const std::string& msg) const {
+	if(p == write_priority::urgent) return true;
+	//a message bigger than the whole allowance waits for a full bucket
+	double bytes_wanted=std::min(msg.size(), limits_.bytes);
+	return ( limits_.lines == 0 || line_tokens_ >= 1 )
+	    && ( limits_.bytes == 0 || byte_tokens_ >= bytes_wanted );
+}
+
+void flood_control::spend(const std::string& msg) {
+	if(limits_.lines != 0) line_tokens_-=1;
+	if(limits_.bytes != 0) byte_tokens_-=msg.size();
+}
+
+void flood_control::push(std::string msg, write_priority p) {
+	assert(static_cast<std::size_t>(p) < lane_count);
+	queued_bytes_+=msg.size();
+	lanes_[static_cast<std::size_t>(p)].push_back(std::move(msg));
+}
+
+flood_control::duration flood_control::next_ready(time_point now) const {
+	auto it=std::find_if(lanes_.begin(), lanes_.end(),
+		[](const std::deque<std::string>& lane) { return !lane.empty(); });
+
+	if(it == lanes_.end() || it == lanes_.begin()) return duration::zero();
+
+	auto elapsed=now - last_refill_;
+	double ticks=0;
+	if(limits_.lines != 0) {
+		double lines=projected(line_tokens_, limits_.lines, lines_per_tick(), elapsed);
+		ticks=std::max(ticks, ticks_until(lines, 1, lines_per_tick()));
+	}
+	if(limits_.bytes != 0) {
+		double bytes=projected(byte_tokens_, limits_.bytes, bytes_per_tick(), elapsed);
+		double wanted=std::min(it->front().size(), limits_.bytes);
+		ticks=std::max(ticks, ticks_until(bytes, wanted, bytes_per_tick()));
+	}
+	return duration { static_cast<duration::rep>(std::ceil(ticks)) };
+}
+
+flood_control::duration flood_control::expected_drain_time(time_point now) const {
+	auto elapsed=now - last_refill_;
+	double ticks=0;
+	if(limits_.lines != 0) {
+		double lines=projected(line_tokens_, limits_.lines, lines_per_tick(), elapsed);
+		ticks=std::max(ticks, ticks_until(lines, queue_depth(), lines_per_tick()));
+	}
+	if(limits_.bytes != 0) {
+		double bytes=projected(byte_tokens_, limits_.bytes, bytes_per_tick(), elapsed);
+		ticks=std::max(ticks, ticks_until(bytes, queued_bytes_, bytes_per_tick()));
+	}
+	return duration { static_cast<duration::rep>(std::ceil(ticks)) };
+}
+
+std::size_t flood_control::queue_depth() const {
+	std::size_t n=0;
+	for(const auto& lane : lanes_) n+=lane.size();
+	return n;
+}
+
+std::size_t flood_control::queue_depth(write_priority p) const {
+	return lanes_[static_cast<std::size_t>(p)].size();
+}
+
+void flood_control::clear() {
+	for(auto& lane : lanes_) lane.clear();
+	queued_bytes_=0;
+}
+
+void flood_control::set_limits(flood_limits limits) {
+	limits_=std::move(limits);
+	line_tokens_=std::min<double>(line_tokens_, limits_.lines);
+	byte_tokens_=std::min<double>(byte_tokens_, limits_.bytes);
+}
+
+const flood_limits& flood_control::get_limits() const {
+	return limits_;
+}
+
+} //namespace irc
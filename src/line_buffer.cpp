@@ -0,0 +1,67 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "line_buffer.hpp"
+
+#include <cassert>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace irc {
+
+const char* find_line_end(const char* first, const char* last) {
+#ifdef __SSE2__
+	//compare 16 bytes at a time, memchr picks up the tail
+	const __m128i nl=_mm_set1_epi8('\n');
+	for(; last-first >= 16; first+=16) {
+		__m128i chunk=_mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+		int mask=_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl));
+		if(mask) return first + __builtin_ctz(mask);
+	}
+#endif
+	if(first == last) return last;
+	auto p=static_cast<const char*>(std::memchr(first, '\n', last-first));
+	return p ? p : last;
+}
+
+line_buffer::line_buffer(std::size_t capacity)
+:	buffer_ ( capacity )
+{
+	assert(capacity > 0);
+}
+
+boost::asio::mutable_buffers_1 line_buffer::prepare() {
+	//a line longer than the buffer, make room for it
+	if(size_ == buffer_.size()) buffer_.resize(buffer_.size() * 2);
+	return boost::asio::buffer(buffer_.data() + size_, buffer_.size() - size_);
+}
+
+void line_buffer::commit(std::size_t n) {
+	assert(size_ + n <= buffer_.size());
+	size_+=n;
+}
+
+void line_buffer::compact(const char* first) {
+	std::size_t consumed=first - buffer_.data();
+	assert(consumed <= size_);
+	if(consumed == 0) return;
+
+	size_-=consumed;
+	std::memmove(buffer_.data(), first, size_);
+}
+
+std::size_t line_buffer::size() const {
+	return size_;
+}
+
+void line_buffer::clear() {
+	size_=0;
+}
+
+} //namespace irc
@@ -0,0 +1,114 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "message_tags.hpp"
+
+namespace irc {
+
+void unescape_tag_value(string_view value, std::string& out) {
+	out.reserve(out.size() + value.size());
+	for(auto it=value.begin(); it != value.end(); ++it) {
+		if(*it != '\\') {
+			out+=*it;
+			continue;
+		}
+		//a lone trailing backslash is dropped
+		if(++it == value.end()) break;
+		switch(*it) {
+		case ':':  out+=';';  break;
+		case 's':  out+=' ';  break;
+		case 'r':  out+='\r'; break;
+		case 'n':  out+='\n'; break;
+		default:   out+=*it;  break; //includes "\\"
+		}
+	}
+}
+
+std::string tag_view::unescaped_value() const {
+	std::string out;
+	unescape_tag_value(value, out);
+	return out;
+}
+
+message_tags::const_iterator::const_iterator(string_view raw)
+:	rest_ ( raw )
+,	end_  ( false )
+{
+	increment();
+}
+
+void message_tags::const_iterator::increment() {
+	//empty tags, as in "a;;b", are skipped
+	while(!rest_.empty() && rest_.front() == ';') rest_.remove_prefix(1);
+	if(rest_.empty()) {
+		end_=true;
+		return;
+	}
+
+	auto end=rest_.find(';');
+	auto tag=rest_.substr(0, end);
+	rest_.remove_prefix(end == string_view::npos ? rest_.size() : end);
+
+	auto eq=tag.find('=');
+	current_.key  =tag.substr(0, eq);
+	current_.value=eq == string_view::npos ? string_view{ } : tag.substr(eq+1);
+}
+
+bool message_tags::const_iterator::equal(const const_iterator& other) const {
+	if(end_ || other.end_) return end_ == other.end_;
+	return rest_.data() == other.rest_.data()
+	    && current_.key.data() == other.current_.key.data();
+}
+
+tag_view message_tags::const_iterator::dereference() const {
+	return current_;
+}
+
+message_tags::message_tags(string_view raw)
+:	raw_ ( raw )
+{	}
+
+message_tags::const_iterator message_tags::begin() const {
+	return const_iterator { raw_ };
+}
+
+message_tags::const_iterator message_tags::end() const {
+	return const_iterator { };
+}
+
+bool message_tags::empty() const {
+	return begin() == end();
+}
+
+string_view message_tags::raw() const {
+	return raw_;
+}
+
+optional_string_view message_tags::find(string_view key) const {
+	optional_string_view value;
+	for(const auto& tag : *this) {
+		if(tag.key == key) value=tag.value;
+	}
+	return value;
+}
+
+bool message_tags::contains(string_view key) const {
+	for(const auto& tag : *this) {
+		if(tag.key == key) return true;
+	}
+	return false;
+}
+
+optional_string message_tags::get(string_view key) const {
+	auto value=find(key);
+	if(!value) return { };
+
+	std::string out;
+	unescape_tag_value(*value, out);
+	return out;
+}
+
+} //namespace irc
@@ -9,9 +9,6 @@
 #include <sstream>
 #include <algorithm>
 
-#include <boost/spirit/include/qi.hpp>
-#include <boost/fusion/include/std_pair.hpp>
-
 namespace irc {
 
 mode_block::const_iterator mode_block::find(char sym) const {
@@ -41,14 +38,10 @@ void mode_block::set_mode_impl(char sym, const optional_string& param) {
 }
 
 void mode_block::apply_mode_diff(const prefix& p, const mode_diff& md) {
-	if(md.change==mode_change::set) {
-		for(const auto& m : md.modes)
-			set_mode_impl(m.first, m.second);
-	}
-	else {
-		for(const auto& m : md.modes)
-			unset_mode_impl(m.first);
-	}
+	for(const auto& m : md.set)
+		set_mode_impl(m.first, m.second);
+	for(const auto& m : md.unset)
+		unset_mode_impl(m.first);
 	on_mode_change(p, md);
 }
 
@@ -91,8 +84,9 @@ std::ostream& operator<<(std::ostream& os, const mode_list& ml) {
 }
 
 std::ostream& operator<<(std::ostream& os, const mode_diff& md) {
-	return os << ( md.change == mode_change::set ? '+' : '-' )
-	          << md.modes;
+	if(!md.set.empty())   os << '+' << md.set;
+	if(!md.unset.empty()) os << '-' << md.unset;
+	return os;
 }
 
 std::string to_string(const mode_block& mb) {
@@ -113,34 +107,119 @@ std::string to_string(const mode_diff& md) {
 	return oss.str();
 }
 
-} //namespace irc
+namespace {
 
-BOOST_FUSION_ADAPT_STRUCT(
-	irc::mode_diff,
-	(irc::mode_change, change)
-	(irc::mode_list,   modes)
-)
+std::size_t index_of(char mode) {
+	return static_cast<unsigned char>(mode);
+}
 
-namespace irc {
+} //namespace
 
-namespace qi=boost::spirit::qi;
+mode_classes::mode_classes() {
+	types_.fill(mode_type::flag);
+	set_chanmodes("beI,k,l,imnpst");
+	set_prefix("(ov)@+");
+}
 
-mode_diff parse_modes(const std::string& entries) {
-	using iterator=std::string::const_iterator;
+void mode_classes::set_chanmodes(string_view chanmodes) {
+	//prefix modes stay as they are, they come from PREFIX
+	for(std::size_t i=0; i!=types_.size(); ++i) {
+		if(types_[i] != mode_type::membership) types_[i]=mode_type::flag;
+	}
 
-	qi::symbols<char, mode_change> add_remove;
-	add_remove.add("+", mode_change::set)("-", mode_change::unset);
-	//TODO should I really use lexeme?
-	qi::rule<iterator, mode_block::value_type()> mode=
-		qi::lexeme[ ~qi::char_(' ')  >> -( ' ' >> +qi::char_ )];
+	static const mode_type order[]={
+		mode_type::list, mode_type::always, mode_type::on_set, mode_type::flag
+	};
+	std::size_t group=0;
+	for(char c : chanmodes) {
+		if(c == ',') {
+			//any groups after D are reserved and taken as flags
+			if(group != 3) ++group;
+			continue;
+		}
+		if(index_of(c) < types_.size() && types_[index_of(c)] != mode_type::membership)
+			types_[index_of(c)]=order[group];
+	}
+}
 
-	qi::rule<iterator, mode_diff(), qi::space_type> modes_diff=
-		add_remove >> +mode;
+bool mode_classes::set_prefix(string_view prefix) {
+	auto close=prefix.find(')');
+	if(prefix.empty() || prefix.front() != '(' || close == string_view::npos)
+		return false;
 
-	mode_diff md;
-	qi::phrase_parse(entries.begin(), entries.end(),
-		modes_diff, qi::space, md);
+	auto modes  =prefix.substr(1, close-1);
+	auto symbols=prefix.substr(close+1);
+	if(modes.size() != symbols.size()) return false;
+
+	for(char c : prefix_modes_) types_[index_of(c)]=mode_type::flag;
+	prefix_modes_.clear();
+	prefix_symbols_.clear();
+	for(std::size_t i=0; i!=modes.size(); ++i) {
+		if(index_of(modes[i]) >= types_.size()) continue;
+		types_[index_of(modes[i])]=mode_type::membership;
+		prefix_modes_  +=modes[i];
+		prefix_symbols_+=symbols[i];
+	}
+	return true;
+}
 
+void mode_classes::apply_isupport(string_view token) {
+	if(token.starts_with("CHANMODES="))
+		set_chanmodes(token.substr(10));
+	else if(token.starts_with("PREFIX="))
+		set_prefix(token.substr(7));
+}
+
+mode_type mode_classes::get_type(char mode) const {
+	return index_of(mode) < types_.size() ? types_[index_of(mode)] : mode_type::flag;
+}
+
+bool mode_classes::takes_param(char mode, mode_change change) const {
+	switch(get_type(mode)) {
+	case mode_type::flag:   return false;
+	case mode_type::on_set: return change == mode_change::set;
+	default:                return true;
+	}
+}
+
+char mode_classes::mode_for_symbol(char symbol) const {
+	auto pos=prefix_symbols_.find(symbol);
+	return pos == std::string::npos ? '\0' : prefix_modes_[pos];
+}
+
+const std::string& mode_classes::get_prefix_modes() const {
+	return prefix_modes_;
+}
+
+const std::string& mode_classes::get_prefix_symbols() const {
+	return prefix_symbols_;
+}
+
+void mode_diff::clear() {
+	set.clear();
+	unset.clear();
+}
+
+bool mode_diff::empty() const {
+	return set.empty() && unset.empty();
+}
+
+mode_diff parse_modes(const std::string& entries) {
+	static const mode_classes rfc_classes;
+
+	//split "+modes arg1 arg2..." on spaces
+	std::vector<string_view> args;
+	string_view rest=entries;
+	while(!rest.empty()) {
+		auto pos=rest.find(' ');
+		if(pos != 0) args.push_back(rest.substr(0, pos));
+		rest.remove_prefix(pos == string_view::npos ? rest.size() : pos+1);
+	}
+
+	mode_diff md;
+	if(!args.empty()) {
+		parse_modes(rfc_classes, args.front(), args.begin()+1, args.end(), md);
+	}
 	return md;
 }
 
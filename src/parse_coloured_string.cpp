@@ -1,42 +1,48 @@
-#include <coloured_string_parser.hpp>
 #include <parse_coloured_string.hpp>
 
+#include <cassert>
+#include <cstring>
 #include <sstream>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace irc {
 
-void rich_string::set_modifier(text_modifiers mod, bool val) {
+void text_style::set_modifier(text_modifiers mod, bool val) {
 	assert(! ( mod == text_modifiers::none || mod == text_modifiers::colour));
 	mods[static_cast<std::size_t>(mod)]=val;
 }
 
-bool rich_string::get_modifier(text_modifiers mod) const {
+bool text_style::get_modifier(text_modifiers mod) const {
 	return mods[static_cast<std::size_t>(mod)];
 }
 
 
 
-bool rich_string::get_bold() const {
+bool text_style::get_bold() const {
 	return get_modifier(text_modifiers::bold);
 }
 
-bool rich_string::get_italic() const {
+bool text_style::get_italic() const {
 	return get_modifier(text_modifiers::italic);
 }
 
-bool rich_string::get_strikethrough() const {
+bool text_style::get_strikethrough() const {
 	return get_modifier(text_modifiers::strikethrough);
 }
 
-bool rich_string::get_reset() const {
+bool text_style::get_reset() const {
 	return get_modifier(text_modifiers::reset);
 }
 
-bool rich_string::get_underline() const {
+bool text_style::get_underline() const {
 	return get_modifier(text_modifiers::underline);
 }
 
-bool rich_string::get_reverse() const {
+bool text_style::get_reverse() const {
 	return get_modifier(text_modifiers::reverse);
 }
 
@@ -50,44 +56,145 @@ colours colour_cast(unsigned value) {
 	return static_cast<colours>(value);
 }
 
-split_string parse_coloured_string(const std::string& raw_msg) {
-	auto first=begin(raw_msg), last=end(raw_msg);
+namespace {
 
-	coloured_string_parser<decltype(first)> parser;
+//parses one or two digits of a colour number
+const char* parse_colour(const char* first, const char* last, colours& c) {
+	unsigned value=*first++ - '0';
+	if(first != last && *first >= '0' && *first <= '9')
+		value=value*10 + (*first++ - '0');
+	c=value < max_colours ? static_cast<colours>(value) : colours::none;
+	return first;
+}
 
-	split_string fstr;
-	//the running state
-	rich_string t;
-
-	//did the parse suceed
-	bool r;
-	do {
-		//the diff from the next chunk
-		text_diff td;
-		//parse
-		r=qi::parse(first, last, parser, td);
-
-		//apply the diff
-		if(td.modifier == text_modifiers::none) {
-			//do nothing
+bool is_digit(const char* it, const char* last) {
+	return it != last && *it >= '0' && *it <= '9';
+}
+
+} //namespace
+
+text_modifiers modifier_for(char c) {
+	static const auto table=[] {
+		std::array<text_modifiers, 0x20> t;
+		t.fill(text_modifiers::none);
+		for(std::size_t i=0; i!=modifier_chars.size(); ++i)
+			t[static_cast<std::size_t>(modifier_chars[i])]=static_cast<text_modifiers>(i);
+		return t;
+	}();
+	auto i=static_cast<unsigned char>(c);
+	return i < table.size() ? table[i] : text_modifiers::none;
+}
+
+namespace detail {
+
+const char* apply_control(text_style& style, text_modifiers mod,
+                          const char* first, const char* last) {
+	switch(mod) {
+	case text_modifiers::none:
+		break;
+	case text_modifiers::colour:
+		//a bare colour code goes back to the default colours
+		style.foreground=colours::none;
+		style.background=colours::none;
+		if(is_digit(first, last)) {
+			first=parse_colour(first, last, style.foreground);
+			//a comma not followed by a digit is just text
+			if(first != last && *first == ',' && is_digit(first+1, last))
+				first=parse_colour(first+1, last, style.background);
 		}
-		else if(td.modifier == text_modifiers::colour) {
-			t.foreground=td.foreground;
-			t.background=td.background;
+		break;
+	case text_modifiers::reset:
+		style=text_style{ };
+		style.set_modifier(text_modifiers::reset, true);
+		break;
+	default:
+		//flip the modifier, eg if was bold unset
+		style.set_modifier(mod, !style.get_modifier(mod));
+		break;
+	}
+	return first;
+}
+
+} //namespace detail
+
+std::size_t parse_coloured_string(string_view raw_msg, std::vector<text_span>& spans) {
+	spans.clear();
+	visit_coloured_string(raw_msg,
+		[&](const text_style& style, string_view text) {
+			spans.push_back(text_span { style, text });
 		}
-		else {
-			//flip the modifier, eg if was bold unset
-			t.set_modifier(td.modifier, !t.get_modifier(td.modifier));
+	);
+	return spans.size();
+}
+
+const char* find_formatting(const char* first, const char* last) {
+#ifdef __SSE2__
+	//every control character is below a space, so pick out those bytes
+	//16 at a time then check the few candidates against the table
+	const __m128i max_control=_mm_set1_epi8(0x1f);
+	for(; last-first >= 16; first+=16) {
+		__m128i chunk=_mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+		int mask=_mm_movemask_epi8(
+			_mm_cmpeq_epi8(_mm_min_epu8(chunk, max_control), chunk));
+		for(; mask; mask&=mask-1) {
+			const char* p=first + __builtin_ctz(mask);
+			if(modifier_for(*p) != text_modifiers::none) return p;
 		}
-		t.value=td.text;
-		fstr.push_back(t);
 	}
-	while(first != last && r);
+#endif
+	for(; first != last; ++first) {
+		if(static_cast<unsigned char>(*first) < 0x20
+		&& modifier_for(*first) != text_modifiers::none) break;
+	}
+	return first;
+}
+
+namespace {
+
+//copies the text in [first, last) to out skipping formatting,
+//out may be first for in place stripping
+char* strip_formatting(const char* first, const char* last, char* out) {
+	text_style ignored;
+	for(const char* ctrl; (ctrl=find_formatting(first, last)) != last; ) {
+		std::memmove(out, first, ctrl-first);
+		out+=ctrl-first;
+		first=detail::apply_control(ignored, modifier_for(*ctrl), ctrl+1, last);
+	}
+	std::memmove(out, first, last-first);
+	return out + (last-first);
+}
+
+} //namespace
 
-	if(!r)
-		throw std::runtime_error(
-			"provided string could not be parsed: " + raw_msg);
+std::string strip_formatting(string_view raw_msg) {
+	const char* first=raw_msg.data();
+	const char* last =first + raw_msg.size();
+	const char* ctrl =find_formatting(first, last);
+	if(ctrl == last) return std::string(first, last);
 
+	std::string out(first, ctrl);
+	out.resize(raw_msg.size());
+	char* end=strip_formatting(ctrl, last, &out[ctrl-first]);
+	out.resize(end - out.data());
+	return out;
+}
+
+void strip_formatting(std::string& msg) {
+	if(msg.empty()) return;
+	char* first=&msg[0];
+	char* end  =strip_formatting(first, first + msg.size(), first);
+	msg.resize(end - first);
+}
+
+split_string parse_coloured_string(const std::string& raw_msg) {
+	split_string fstr;
+	visit_coloured_string(raw_msg,
+		[&](const text_style& style, string_view text) {
+			fstr.emplace_back();
+			static_cast<text_style&>(fstr.back())=style;
+			fstr.back().value.assign(text.data(), text.size());
+		}
+	);
 	return fstr;
 }
 
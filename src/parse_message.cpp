@@ -7,41 +7,185 @@
 //Created:     2014/01/17
 
 #include "message.hpp"
-#include "message_parser.hpp"
+#include "message_view.hpp"
+#include "line_buffer.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <string>
 #include <tuple>
-
-//This has it's own file because parser.hpp takes ages to compile
+#include <utility>
 
 namespace irc {
 
+namespace {
+
+bool parse_numeric(string_view token, command& cmd) {
+	//The command MUST either be a valid IRC command
+	//or a three (3) digit number represented in ASCII text.
+	if(token.size() != 3) return false;
+
+	raw_command_t value=0;
+	for(char c : token) {
+		if(c < '0' || c > '9') return false;
+		value=value*10 + (c - '0');
+	}
+	cmd=is_command(value) ? static_cast<command>(value) : command::unknown;
+	return true;
+}
+
+bool parse_command(string_view token, command& cmd) {
+	if(verb_to_command(token, cmd) || parse_numeric(token, cmd))
+		return true;
+
+	//an unlisted verb is still a well formed message
+	if(token.empty()) return false;
+	for(char c : token) {
+		if(!( (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') )) return false;
+	}
+	cmd=command::unknown;
+	return true;
+}
+
+//nick[!user][@host], anything that doesn't start with a nick is a host
+void parse_prefix(string_view raw, prefix_view& pfx) {
+	auto host_pos=raw.find('@');
+	auto user_pos=raw.substr(0, host_pos).find('!');
+	auto nick_end=std::min(user_pos, host_pos);
+
+	if(nick_end == 0) {
+		pfx.host=raw;
+		return;
+	}
+	pfx.nick=raw.substr(0, nick_end);
+	if(user_pos != string_view::npos) {
+		pfx.user=raw.substr(user_pos+1, host_pos-user_pos-1);
+	}
+	if(host_pos != string_view::npos) {
+		pfx.host=raw.substr(host_pos+1);
+	}
+}
+
+string_view next_token(string_view& raw) {
+	auto pos=raw.find(' ');
+	auto token=raw.substr(0, pos);
+	raw.remove_prefix(pos == string_view::npos ? raw.size() : pos);
+	return token;
+}
+
+void skip_spaces(string_view& raw) {
+	while(!raw.empty() && raw.front() == ' ') raw.remove_prefix(1);
+}
+
+} //namespace
+
+prefix prefix_view::to_prefix() const {
+	return prefix { *this };
+}
+
+message_view::const_iterator message_view::begin() const {
+	return params.begin();
+}
+message_view::const_iterator message_view::end() const {
+	return params.begin() + param_count;
+}
+std::size_t message_view::size() const {
+	return param_count;
+}
+bool message_view::empty() const {
+	return param_count == 0;
+}
+string_view message_view::operator[](std::size_t n) const {
+	assert(n < param_count);
+	return params[n];
+}
+
+message message_view::to_message() const {
+	message msg;
+	msg.tags=tags.raw().to_string();
+	if(prefix) msg.prefix=prefix->to_prefix();
+	msg.command=command;
+	msg.raw_command=raw_command.to_string();
+	for(const auto& p : *this) msg.params.push_back(p.to_string());
+	return msg;
+}
+
+bool parse_message(string_view raw, message_view& msg) {
+	while(!raw.empty() && (raw.back() == '\n' || raw.back() == '\r'))
+		raw.remove_suffix(1);
+
+	msg.tags=message_tags { };
+	msg.prefix=boost::none;
+	msg.param_count=0;
+
+	skip_spaces(raw);
+	if(!raw.empty() && raw.front() == '@') {
+		raw.remove_prefix(1);
+		auto tags=next_token(raw);
+		if(tags.empty()) return false;
+
+		//only the span is recorded, tags are split when looked up
+		msg.tags=message_tags { tags };
+		skip_spaces(raw);
+	}
+	if(!raw.empty() && raw.front() == ':') {
+		raw.remove_prefix(1);
+		auto pfx=next_token(raw);
+		if(pfx.empty()) return false;
+
+		msg.prefix=prefix_view{ };
+		parse_prefix(pfx, *msg.prefix);
+		skip_spaces(raw);
+	}
+
+	msg.raw_command=next_token(raw);
+	if(!parse_command(msg.raw_command, msg.command))
+		return false;
+
+	for(skip_spaces(raw); !raw.empty(); skip_spaces(raw)) {
+		//the final parameter takes the remainder of the line
+		if(raw.front() == ':' || msg.param_count == max_params-1) {
+			if(raw.front() == ':') raw.remove_prefix(1);
+			msg.params[msg.param_count++]=raw;
+			break;
+		}
+		msg.params[msg.param_count++]=next_token(raw);
+	}
+	return true;
+}
+
+std::size_t parse_messages(string_view                buffer,
+                           std::vector<message_view>& msgs,
+                           std::size_t&               failed) {
+	msgs.clear();
+	failed=0;
+
+	const char* first=buffer.data();
+	const char* last =first + buffer.size();
+	for(const char* eol; (eol=find_line_end(first, last)) != last; first=eol+1) {
+		string_view line(first, eol-first);
+		if(line.empty() || line == "\r") continue;
+
+		//parse in place, a failed line gives its slot back
+		msgs.emplace_back();
+		if(!parse_message(line, msgs.back())) {
+			msgs.pop_back();
+			++failed;
+		}
+	}
+	return first - buffer.data();
+}
+
+std::size_t parse_messages(string_view                buffer,
+                           std::vector<message_view>& msgs) {
+	std::size_t failed;
+	return parse_messages(buffer, msgs, failed);
+}
+
 std::tuple<bool, message> parse_message(const std::string &raw_msg) {
-    using iterator_type =std::string::const_iterator;
-    using message_parser=message_parser<iterator_type>;
- 
-    message_parser parser;
-    message        msg;
-    iterator_type  first=raw_msg.begin(),
-	               last=raw_msg.end();
-
-	qi::space_type space;
-
-    bool r=qi::phrase_parse(first, last, parser, space, msg);
- 
-#ifdef IRC_DEBUG
-    std::cout << raw_msg << '\n';
-    if( r && iter == end ) {
-        std::cout << "#prefix :" << msg.prefix  << '\n';
-        std::cout << "#command:" << msg.command << '\n';
-        std::cout << "#params :" << msg.params  << '\n';
-    }
-    else {
-        std::cout << "Parsing failed\n";
-    }
-#endif
-
-    return std::make_tuple(r, msg);
+	message_view view;
+	bool r=parse_message(raw_msg, view);
+	return std::make_tuple(r, r ? view.to_message() : message{ });
 }
 
 } //namespace irc
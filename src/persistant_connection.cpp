@@ -2,18 +2,41 @@
 #include "simple_connection.hpp"
 #include "exception.hpp"
 
+#include <sstream>
+
 namespace irc {
 
+constexpr std::size_t persistant_connection::max_standby_lines;
+
+persistant_connection::persistant_connection(ba::io_service& io_service,
+		std::string hostname, std::string service)
+:	persistant_connection ( io_service,
+		std::vector<server_endpoint> {
+			server_endpoint { std::move(hostname), std::move(service) } } )
+{	}
+
 persistant_connection::persistant_connection(ba::io_service& io_service,
-		const std::string hostname, const std::string service)
-:	io_service_ ( io_service          )
-,	hostname_   { std::move(hostname) }
-,	service_    { std::move(service)  }
+		std::vector<server_endpoint> servers, reconnect_policy policy)
+:	io_service_      ( io_service         )
+,	servers_         ( std::move(servers) )
+,	flood_timer_     ( io_service         )
+,	backoff_         ( policy             )
+,	reconnect_timer_ ( io_service         )
+,	standby_backoff_ ( std::move(policy)  )
+,	standby_timer_   ( io_service         )
 {
+	if(servers_.empty()) {
+		throw IRC_MAKE_EXCEPTION("No servers to connect to");
+	}
 	initiate_connection();
 }
 
 persistant_connection::~persistant_connection() {
+	//cancelling doesn't stop handlers whose wait already finished
+	alive_.reset();
+	cancel_reconnect();
+	close_standby();
+	clear_writes();
 	clear_callbacks();
 	if(connection_) connection_->disconnect();
 }
@@ -22,52 +45,351 @@ void persistant_connection::clear_callbacks() {
 	for(auto& cb : callbacks_)
 		cb.disconnect();
 	callbacks_.clear();
+	if(connection_) connection_->set_read_handler(nullptr);
 }
 
 void persistant_connection::failure_handler(const std::string& str) {
+	auto now=clock::now();
+	//a failed reconnect is still the same outage
+	if(!failed_at_) failed_at_=now;
+	//a server dropping us straight after accepting is still backed off from
+	if(connected_at_ && now - *connected_at_ >= backoff_.get_policy().stable_after)
+		backoff_.reset();
+	connected_at_=boost::none;
+
 	on_disconnect(str);
 	//At this point we have decided that our socket is done for
 	//clears all the connection handlers to the basic connection
 	clear_callbacks();
+	clear_writes();
 	connection_.reset();
+	read_started_=false;
 
-	schedule_reconnect();
+	if(standby_ready_) promote_standby();
+	else {
+		close_standby();
+		schedule_reconnect();
+	}
 }
 
 
 void persistant_connection::initiate_connection() {
 	connection_=std::make_shared<simple_connection>(io_service_);
+	established_=false;
 
+	callbacks_.push_back(connection_->connect_on_connect(
+		[this](const std::string&) { handle_connected(); }));
 	callbacks_.push_back(connection_->connect_on_connect(on_connect));
 	callbacks_.push_back(connection_->connect_on_resolve(on_resolve));
-	callbacks_.push_back(connection_->connect_on_read(on_read));
+	attach_connection();
+
+	//we have to do this because connection is a shared_ptr
+	const server_endpoint& server=servers_[server_index_];
+	connection_->start(server.hostname, server.service);
+}
+
+void persistant_connection::attach_connection() {
+	//lines go straight to the handler, on_read is only emitted if observed
+	connection_->set_read_handler(
+		[this](string_view line) {
+			if(read_handler_) read_handler_(line);
+			on_read(line);
+		}
+	);
 	callbacks_.push_back(connection_->connect_on_error(
 		std::bind(&persistant_connection::failure_handler, this, ph::_1)));
+}
 
-	//we have to do this because connection is a shared_ptr
-	connection_->start(hostname_, service_);
+void persistant_connection::handle_connected() {
+	//whoever started reading the last connection expects this one read too
+	if(reading_ && !read_started_) {
+		read_started_=true;
+		connection_->start_read();
+	}
+	if(hot_standby_) open_standby();
+	if(!hold_until_established_) mark_established();
+	else                         flush_writes();
+}
+
+void persistant_connection::mark_established() {
+	if(!connection_ || established_) return;
+
+	established_ =true;
+	connected_at_=clock::now();
+	//the outage only ends once we can be used again
+	if(failed_at_) {
+		last_failover_=*connected_at_ - *failed_at_;
+		failed_at_=boost::none;
+	}
+	flush_writes();
 }
 
 void persistant_connection::schedule_reconnect() {
-	//TODO: this should try again instantly on first error
-	//then space out by 5seconds, 15second, 30seconds, 1min, ..., 1min, ...
-	initiate_connection();
+	if(backoff_.exhausted()) {
+		on_give_up();
+		return;
+	}
+	//a server that just failed is the last one we want to try again
+	server_index_=(server_index_ + 1) % servers_.size();
+
+	//even an immediate retry goes through the timer, we are still
+	//inside the failed connection's error handler
+	auto delay=backoff_.next_delay();
+	next_reconnect_=clock::now() + delay;
+	reconnect_timer_.expires_from_now(delay);
+	std::weak_ptr<bool> alive=alive_;
+	reconnect_timer_.async_wait(
+		[this, alive](const boost::system::error_code& error) {
+			//cancelled, or already due when we were destroyed
+			if(error || alive.expired()) return;
+			next_reconnect_=boost::none;
+			initiate_connection();
+		}
+	);
+}
+
+void persistant_connection::cancel_reconnect() {
+	next_reconnect_=boost::none;
+	boost::system::error_code error;
+	reconnect_timer_.cancel(error);
 }
 
+void persistant_connection::open_standby() {
+	if(standby_ || !connection_) return;
 
-void persistant_connection::write(std::string msg) {
+	standby_index_=(server_index_ + 1) % servers_.size();
+	standby_=std::make_shared<simple_connection>(io_service_);
+
+	standby_callbacks_.push_back(standby_->connect_on_connect(
+		[this](const std::string&) {
+			standby_ready_=true;
+			//reading is how we find out the server dropped it
+			standby_->start_read();
+		}
+	));
+	standby_callbacks_.push_back(standby_->connect_on_error(
+		[this](const std::string&) { standby_failed(); }));
+	standby_->set_read_handler(
+		[this](string_view line) {
+			if(standby_lines_.size() < max_standby_lines)
+				standby_lines_.emplace_back(line.data(), line.size());
+		}
+	);
+
+	const server_endpoint& server=servers_[standby_index_];
+	standby_->start(server.hostname, server.service);
+}
+
+void persistant_connection::close_standby() {
+	for(auto& cb : standby_callbacks_)
+		cb.disconnect();
+	standby_callbacks_.clear();
+	if(standby_) {
+		standby_->set_read_handler(nullptr);
+		standby_->disconnect();
+		standby_.reset();
+	}
+	standby_ready_=false;
+	standby_lines_.clear();
+	boost::system::error_code error;
+	standby_timer_.cancel(error);
+}
+
+void persistant_connection::standby_failed() {
+	close_standby();
+	if(!hot_standby_ || !connection_) return;
+
+	//don't spin against a server which is refusing us, nor keep
+	//reconnecting to one which drops us for never registering
+	if(standby_backoff_.exhausted()) return;
+	standby_timer_.expires_from_now(standby_backoff_.next_delay());
+	std::weak_ptr<bool> alive=alive_;
+	standby_timer_.async_wait(
+		[this, alive](const boost::system::error_code& error) {
+			//cancelled, or already due when we were destroyed
+			if(error || alive.expired()) return;
+			open_standby();
+		}
+	);
+}
+
+void persistant_connection::promote_standby() {
+	for(auto& cb : standby_callbacks_)
+		cb.disconnect();
+	standby_callbacks_.clear();
+
+	connection_   =std::move(standby_);
+	established_  =false;
+	//it was worth keeping, the next one starts the curve over
+	standby_backoff_.reset();
+	server_index_ =standby_index_;
+	standby_ready_=false;
+	//the standby has been reading since it connected
+	read_started_ =true;
+	attach_connection();
+
+	std::vector<std::string> lines;
+	lines.swap(standby_lines_);
+
+	handle_connected();
+	std::ostringstream oss;
+	oss << "Promoted standby connection"
+	    << " Host: "    << get_hostname()
+	    << " Service: " << get_service();
+	on_connect(oss.str());
+
+	for(const auto& line : lines) {
+		if(!connection_) return; //handlers may have stopped us
+		if(read_handler_) read_handler_(line);
+		on_read(line);
+	}
+}
+
+
+void persistant_connection::write(std::string msg, write_priority priority) {
 	if(!connection_) {
 		throw IRC_MAKE_EXCEPTION("Can not write to a failed socket");
 	}
-	//may also throw, !connection_->is_ready();
-	connection_->write(std::move(msg));
+	flood_control_.push(std::move(msg), priority);
+	flush_writes();
+}
+
+void persistant_connection::flush_writes() {
+	//lines wait in the queue until connected, handle_connected flushes
+	if(!connection_ || !connection_->is_ready()) return;
+
+	//until the owner says we're established only registration goes out,
+	//mark_established flushes the rest
+	bool held=hold_until_established_ && !established_;
+	auto lowest=held ? write_priority::urgent : write_priority::bulk;
+	auto now=flood_control::clock::now();
+	flood_control_.drain(now,
+		[this](std::string msg) {
+			connection_->write(std::move(msg));
+		},
+		lowest
+	);
+
+	auto waiting=held ? flood_control_.queue_depth(write_priority::urgent)
+	                  : flood_control_.queue_depth();
+	if(waiting != 0)
+		schedule_flush(flood_control_.next_ready(now));
+}
+
+void persistant_connection::schedule_flush(flood_control::duration delay) {
+	if(flood_timer_armed_) return;
+
+	flood_timer_armed_=true;
+	flood_timer_.expires_from_now(delay);
+	std::weak_ptr<bool> alive=alive_;
+	flood_timer_.async_wait(
+		[this, alive](const boost::system::error_code& error) {
+			//cancelled, or already due when we were destroyed
+			if(error || alive.expired()) return;
+			flood_timer_armed_=false;
+			flush_writes();
+		}
+	);
+}
+
+void persistant_connection::clear_writes() {
+	flood_control_.clear();
+	flood_timer_armed_=false;
+	boost::system::error_code error;
+	flood_timer_.cancel(error);
+}
+
+void persistant_connection::set_flood_limits(flood_limits limits) {
+	flood_control_.set_limits(std::move(limits));
+}
+
+const flood_limits& persistant_connection::get_flood_limits() const {
+	return flood_control_.get_limits();
+}
+
+std::size_t persistant_connection::get_queue_depth() const {
+	return flood_control_.queue_depth();
+}
+
+flood_control::duration persistant_connection::get_expected_drain_time() const {
+	return flood_control_.expected_drain_time(flood_control::clock::now());
 }
 
 void persistant_connection::start_read() {
 	if(!connection_) {
 		throw IRC_MAKE_EXCEPTION("Can not start reading on failed socket");
 	}
-	connection_->start_read();
+	reading_=true;
+	if(!read_started_) {
+		read_started_=true;
+		connection_->start_read();
+	}
+}
+
+void persistant_connection::set_read_handler(read_handler handler) {
+	read_handler_=std::move(handler);
+}
+
+const std::string persistant_connection::get_hostname() const {
+	return servers_[server_index_].hostname;
+}
+
+const std::string persistant_connection::get_service() const {
+	return servers_[server_index_].service;
+}
+
+const std::vector<server_endpoint>& persistant_connection::get_servers() const {
+	return servers_;
+}
+
+void persistant_connection::set_reconnect_policy(reconnect_policy policy) {
+	backoff_.set_policy(policy);
+	standby_backoff_.set_policy(std::move(policy));
+}
+
+const reconnect_policy& persistant_connection::get_reconnect_policy() const {
+	return backoff_.get_policy();
+}
+
+void persistant_connection::set_hot_standby(bool enabled) {
+	hot_standby_=enabled;
+	if(!hot_standby_)   close_standby();
+	else if(is_ready()) open_standby();
+}
+
+void persistant_connection::set_hold_until_established(bool hold) {
+	hold_until_established_=hold;
+	flush_writes();
+}
+
+bool persistant_connection::is_established() const {
+	return connection_ && established_;
+}
+
+bool persistant_connection::get_hot_standby() const {
+	return hot_standby_;
+}
+
+bool persistant_connection::has_standby() const {
+	return standby_ready_;
+}
+
+boost::optional<persistant_connection::duration>
+persistant_connection::get_last_failover_time() const {
+	return last_failover_;
+}
+
+std::size_t persistant_connection::get_reconnect_attempts() const {
+	return backoff_.attempts();
+}
+
+boost::optional<persistant_connection::time_point>
+persistant_connection::get_next_reconnect() const {
+	return next_reconnect_;
+}
+
+ba::io_service& persistant_connection::get_io_service() const {
+	return io_service_;
 }
 
 bool persistant_connection::is_ready() const {
@@ -75,11 +397,15 @@ bool persistant_connection::is_ready() const {
 }
 
 void persistant_connection::stop() {
+	cancel_reconnect();
+	close_standby();
 	if(connection_) {
+		clear_writes();
 		clear_callbacks();
 		connection_->disconnect();
 		connection_.reset();
 	}
+	reading_=read_started_=false;
 }
 
 } //namespace irc
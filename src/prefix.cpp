@@ -5,29 +5,86 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 
 #include "prefix.hpp"
+#include "message_view.hpp"
+#include "exception.hpp"
 
+#include <cstdint>
 #include <sstream>
 
 namespace irc {
 
-prefix::prefix(optional_string nick_, 
-               optional_string user_, 
-               optional_string host_) 
-:	nick { std::move(nick_) }
-,	user { std::move(user_) }
-,	host { std::move(host_) }
-{	}
+namespace {
 
-prefix::prefix(optional_string nick_)
-:	nick { std::move(nick_) }
-{	}
+constexpr std::uint8_t nick_bit=1, user_bit=2, host_bit=4;
+
+optional_string_view as_view(const optional_string& s) {
+	return s ? optional_string_view { *s } : boost::none;
+}
+
+} //namespace
+
+prefix::prefix(const optional_string& nick_,
+               const optional_string& user_,
+               const optional_string& host_)
+{
+	assign(as_view(nick_), as_view(user_), as_view(host_));
+}
+
+prefix::prefix(const optional_string& nick_)
+{
+	assign(as_view(nick_), boost::none, boost::none);
+}
+
+prefix::prefix(const prefix_view& pfx)
+{
+	assign(pfx.nick, pfx.user, pfx.host);
+}
+
+void prefix::assign(const optional_string_view& nick_,
+                    const optional_string_view& user_,
+                    const optional_string_view& host_) {
+	std::size_t size=(nick_ ? nick_->size() : 0)
+	                +(user_ ? user_->size() : 0)
+	                +(host_ ? host_->size() : 0);
+	if(size > UINT16_MAX) {
+		throw IRC_MAKE_EXCEPTION("prefix is too long");
+	}
+
+	buffer_.clear();
+	buffer_.reserve(size);
+	parts_=0;
+	if(nick_) { buffer_.append(nick_->data(), nick_->size()); parts_|=nick_bit; }
+	user_pos_=static_cast<std::uint16_t>(buffer_.size());
+	if(user_) { buffer_.append(user_->data(), user_->size()); parts_|=user_bit; }
+	host_pos_=static_cast<std::uint16_t>(buffer_.size());
+	if(host_) { buffer_.append(host_->data(), host_->size()); parts_|=host_bit; }
+}
+
+optional_string_view prefix::part(std::uint8_t bit,
+                                  std::size_t first, std::size_t last) const {
+	if(!(parts_ & bit)) return boost::none;
+	return string_view { buffer_.data() + first, last - first };
+}
+
+optional_string_view prefix::nick() const {
+	return part(nick_bit, 0, user_pos_);
+}
+
+optional_string_view prefix::user() const {
+	return part(user_bit, user_pos_, host_pos_);
+}
+
+optional_string_view prefix::host() const {
+	return part(host_bit, host_pos_, buffer_.size());
+}
 
 std::ostream& operator<<(std::ostream& os, const prefix& pfx) {
-	if(pfx.nick) os << '<' << *pfx.nick << '>';
-	if(pfx.nick && pfx.user) os << "!";
-	if(pfx.user) os << '<' << *pfx.user << '>';
-	if(pfx.host && ( pfx.nick || pfx.user )) os << "@";
-	if(pfx.host) os << '<' <<  *pfx.host << '>';
+	auto nick=pfx.nick(), user=pfx.user(), host=pfx.host();
+	if(nick) os << '<' << *nick << '>';
+	if(nick && user) os << "!";
+	if(user) os << '<' << *user << '>';
+	if(host && ( nick || user )) os << "@";
+	if(host) os << '<' <<  *host << '>';
 	return os;
 }
 
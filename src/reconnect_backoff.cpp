@@ -0,0 +1,68 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "reconnect_backoff.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace irc {
+
+reconnect_backoff::reconnect_backoff(reconnect_policy policy, unsigned seed)
+:	policy_ ( std::move(policy) )
+,	random_ ( seed              )
+{	}
+
+reconnect_backoff::duration reconnect_backoff::next_delay() {
+	std::size_t attempt=attempts_++;
+	double delay;
+	if(attempt == 0) {
+		//everyone dropped together retries first, spread them out most
+		delay=policy_.first_delay.count();
+		if(policy_.first_spread.count() > 0) {
+			std::uniform_real_distribution<double> spread {
+				0, static_cast<double>(policy_.first_spread.count()) };
+			delay+=spread(random_);
+		}
+	}
+	else {
+		//in floating point so a long outage can't overflow before the cap
+		delay=policy_.base_delay.count()
+		     * std::pow(std::max(policy_.multiplier, 1.0), attempt - 1);
+		delay=std::min<double>(delay, policy_.max_delay.count());
+
+		double jitter=std::min(std::max(policy_.jitter, 0.0), 1.0);
+		if(jitter != 0) {
+			std::uniform_real_distribution<double> take { 0, jitter };
+			delay-=delay * take(random_);
+		}
+	}
+	return std::chrono::duration_cast<duration>(
+		std::chrono::duration<double, std::milli> { delay });
+}
+
+bool reconnect_backoff::exhausted() const {
+	return policy_.max_attempts != 0 && attempts_ >= policy_.max_attempts;
+}
+
+void reconnect_backoff::reset() {
+	attempts_=0;
+}
+
+std::size_t reconnect_backoff::attempts() const {
+	return attempts_;
+}
+
+void reconnect_backoff::set_policy(reconnect_policy policy) {
+	policy_=std::move(policy);
+}
+
+const reconnect_policy& reconnect_backoff::get_policy() const {
+	return policy_;
+}
+
+} //namespace irc
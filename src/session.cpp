@@ -8,16 +8,16 @@
 #include "session.hpp"
 #include "persistant_connection.hpp"
 #include "message.hpp"
+#include "message_view.hpp"
 #include "channel.hpp"
 #include "prefix.hpp"
 #include "user.hpp"
 
 #include "util.hpp"
 
-#include <boost/algorithm/string/predicate.hpp>
-
 #include <tuple> //tie
 #include <sstream> //ostringstream
+#include <vector>
 
 #include <fstream> //ostringstream
 
@@ -41,13 +41,14 @@ void session::join_sequence() {
 	if(realname_.empty()) oss << "*\r\n";
 	else                  oss << realname_ << "\r\n";
 
-	connection_->write(oss.str());
+	//registration goes ahead of anything already queued
+	connection_->write(oss.str(), write_priority::urgent);
 
 	oss.str({ });
 	oss.clear();
 
 	oss << "NICK " << nickname_ << "\r\n";
-	connection_->write(oss.str());
+	connection_->write(oss.str(), write_priority::urgent);
 }
 
 void session::rejoin_sequence() {
@@ -56,19 +57,44 @@ void session::rejoin_sequence() {
 
 void session::handle_connection_established() {
 	active_=true;
-	//TODO: rejoining channels functionality
-	//rejoin_channels();
+	//held writes can go now, registration is done
+	connection_->mark_established();
+
+	std::vector<std::string> channels;
+	channels.swap(rejoin_);
+	for(const auto& name : channels) async_join(name);
+
 	on_connection_established();
 }
 
+void session::reset_state() {
+	active_=false;
+	motd_.clear();
+
+	//the server has forgotten us, so forget what it told us and
+	//rejoin once registered again
+	auto channels=std::move(channels_);
+	channels_.clear();
+	for(auto& ch : channels) {
+		rejoin_.push_back(ch.second->get_name_impl());
+		ch.second->part();
+	}
+
+	shared_user self;
+	auto self_it=users_.find(key_for(nickname_));
+	if(self_it != users_.end()) self=self_it->second;
+	users_.clear();
+	if(self) users_.emplace(key_for(nickname_), std::move(self));
+}
+
 void session::handle_nick(const prefix& pfx, const std::string& new_nick) {
 	//TODO: maybe this should just be get_user?
-	if(!pfx.nick) {
+	if(!pfx.nick()) {
 		on_irc_error("Can not change nick, old nick in prefix is missing");
 		return;
 	}
 
-	auto user_it=users_.find(*pfx.nick);
+	auto user_it=users_.find(key_for(*pfx.nick()));
 
 	if(user_it == users_.cend()) {
 		on_irc_error("Can not change nick, original nick not in system");
@@ -77,24 +103,26 @@ void session::handle_nick(const prefix& pfx, const std::string& new_nick) {
 
 	auto user=user_it->second;
 
-	bool is_self=user.get() == &get_self();
+	bool self=is_self(*pfx.nick());
 
 	if(user->get_nick() != new_nick) {
-		bool success;
-		user_iterator uit;
-		std::tie(uit, success)=users_.emplace(new_nick, std::move(user));
+		bool success=true;
+		auto new_key=key_for(new_nick);
+		//a change of case only keeps the same key
+		if(new_key != user_it->first) {
+			users_.erase(user_it);
+			//if it's failed then that user is still fucked right?
+			success=users_.emplace(std::move(new_key), user).second;
+		}
 
 		if(success) {
-			if(is_self) {
+			if(self) {
 				nickname_=new_nick;
 				on_nick_change(new_nick);
 			}
 
-			uit->second->set_nick(new_nick);
+			user->set_nick(new_nick);
 		}
-
-		//if it's failed then that user is still fucked right?
-		users_.erase(user_it);
 	}
 }
 
@@ -106,48 +134,44 @@ void session::handle_nick_in_use() {
 	else   nickname_+='_';
 
 	self_it->second->set_nick(nickname_); //why do we keep these in sync? just use one?
-	users_[nickname_]=std::move(self_it->second);
+	auto self=std::move(self_it->second);
 	users_.erase(self_it);
+	users_[key_for(nickname_)]=std::move(self);
 
-	connection_->write("NICK "+nickname_+"\r\n");
+	connection_->write("NICK "+nickname_+"\r\n", write_priority::urgent);
 }
 
 
+void session::handle_line(string_view raw_msg) {
+	try {
+		message_view view;
+		if(parse_message(raw_msg, view)) {
+			auto msg=view.to_message();
+			current_tags_=view.tags;
+			handle_reply(msg.prefix ? *msg.prefix : prefix{},
+				msg.command, msg.params);
+			current_tags_=message_tags { };
+		}
+		else {
+			std::ostringstream oss;
+			oss << "could not parse command: " << raw_msg;
+			on_protocol_error(oss.str());
+		}
+	}
+	catch(const std::exception& e) {
+		current_tags_=message_tags { };
+		//TODO: we need to be more specific here, these all irc_errors
+		std::ostringstream oss;
+		oss << "could not parse command: " << e.what();
+		on_irc_error(oss.str());
+	}
+}
+
 void session::prepare_connection() {
 	assert(connection_);
 
-	on_connect_handle.disconnect();
-
-	connection_->connect_on_read(
-		[&](const std::string& raw_msg) {
-			try {
-				bool success;
-				message msg;
-				std::tie(success, msg)=parse_message(raw_msg);
-				if(success) {
-					handle_reply(msg.prefix ? *msg.prefix : prefix{},
-						msg.command, msg.params);
-				}
-				else {
-					std::ostringstream oss;
-					oss << "could not parse command: " << raw_msg;
-					on_protocol_error(oss.str());
-				}
-			}
-			catch(const std::exception& e) {
-				//TODO: we need to be more specific here, these all irc_errors
-				std::ostringstream oss;
-				oss << "could not parse command: " << e.what();
-				on_irc_error(oss.str());
-			}
-		}
-	);
+	//every new connection, including a promoted standby, is registered
 	connection_->start_read();
-	connection_->connect_on_disconnect(
-		[this](const std::string& msg) {
-			active_=false;
-		}
-	);
 	join_sequence();
 }
 
@@ -156,30 +180,42 @@ session::session(std::unique_ptr<persistant_connection>&& conn,
                  std::string username,
 				 std::string realname)
 :	connection_ { std::move(conn)     }
+,	pool_       { std::make_shared<slab_pool>() }
 ,	nickname_   { std::move(nickname) }
 ,	username_   { std::move(username) }
 ,	realname_   { std::move(realname) }
+,	outbox_     { std::make_shared<outbox>() }
 {
 	assert(connection_ && "connection is invalid from start");
+	outbox_->owner=this;
 
-	if(connection_->is_ready()) {
-		prepare_connection();
-	}
-	else {
-		on_connect_handle=connection_->connect_on_connect(
-			std::bind(&session::prepare_connection, this));
-	}
+	//only registration goes out until RPL_WELCOME
+	connection_->set_hold_until_established(true);
+	connection_->set_read_handler(
+		[this](string_view raw_msg) { handle_line(raw_msg); });
+	connection_->connect_on_disconnect(
+		[this](const std::string& msg) { reset_state(); });
+	on_connect_handle=connection_->connect_on_connect(
+		std::bind(&session::prepare_connection, this));
+
+	if(connection_->is_ready()) prepare_connection();
+}
+
+session::~session() {
+	//a drain may still be posted, it holds the outbox not the session
+	outbox_->owner=nullptr;
 }
 
 
 session::channel_iterator session::create_new_channel(const std::string& channel_name) {
-	assert(channels_.count(channel_name)==0);
+	assert(channels_.count(key_for(channel_name))==0);
 
 	channel_iterator it;
 	bool             success;
 
 	std::tie(it, success)=channels_.emplace(
-		channel_name, std::make_shared<channel_impl>(*this, channel_name));
+		key_for(channel_name), std::allocate_shared<channel_impl>(
+			slab_allocator<channel_impl>(pool_), *this, channel_name));
 
 	if(!success)
 		throw IRC_MAKE_EXCEPTION("Unable to insert new channel: " + channel_name);
@@ -188,7 +224,7 @@ session::channel_iterator session::create_new_channel(const std::string& channel
 }
 
 session::channel_iterator session::get_or_create_channel(const std::string& channel_name) {
-	auto it=channels_.find(channel_name);
+	auto it=channels_.find(key_for(channel_name));
 
 	if(it!=channels_.cend())
 		return it;
@@ -198,14 +234,15 @@ session::channel_iterator session::get_or_create_channel(const std::string& chan
 
 session::user_iterator session::create_new_user(const std::string& name,
                                                 const prefix& pfx) {
-	assert(users_.count(name)==0);
+	assert(users_.count(key_for(name))==0);
 	user_iterator it;
 	bool          success;
 
 	std::tie(it, success)=users_.emplace(
-		name, std::make_shared<user_impl>(name, pfx));
+		key_for(name), std::allocate_shared<user_impl>(
+			slab_allocator<user_impl>(pool_), name, pfx));
 
-	if(name!=get_nick()) { //or maybe user==get_self() ?
+	if(!is_self(name)) { //or maybe user==get_self() ?
 		on_new_user(*it->second);
 	}
 
@@ -220,7 +257,7 @@ session::user_iterator session::get_or_create_user(const std::string& username)
 
 	const auto& mus=is_operator(username) ? username.substr(1) : username;
 
-	auto it=users_.find(mus);
+	auto it=users_.find(key_for(mus));
 
 	if(it!=users_.cend())
 		return it;
@@ -229,13 +266,13 @@ session::user_iterator session::get_or_create_user(const std::string& username)
 }
 
 session::user_iterator session::get_or_create_user(const prefix& pfx) {
-	assert(pfx.nick);
-	auto it=users_.find(*pfx.nick);
+	assert(pfx.nick());
+	auto it=users_.find(key_for(*pfx.nick()));
 
 	if(it!=users_.cend())
 		return it;
 	else
-		return create_new_user(*pfx.nick, pfx);
+		return create_new_user(pfx.nick()->to_string(), pfx);
 }
 
 
@@ -245,10 +282,10 @@ session::user_iterator session::get_or_create_user(const prefix& pfx) {
 void session::handle_privmsg(const prefix& pfx,
                              const std::string& target,
                              const std::string& content) {
-	if(pfx.nick) { //nick is an optional
+	if(pfx.nick()) { //nick is an optional
 		auto user=get_or_create_user(pfx)->second; //TODO: by ref or move?
 		assert(user);
-		if(target == nickname_) { //1 to 1
+		if(is_self(target)) { //1 to 1
 			user->direct_message(content);
 		}
 		else { //1 to channel
@@ -265,7 +302,7 @@ void session::handle_privmsg(const prefix& pfx,
 void session::handle_notice (const prefix&      pfx,
                              const std::string& target,
                              const std::string& msg) {
-	if(pfx.nick) {
+	if(pfx.nick()) {
 		auto user=get_or_create_user(pfx)->second;
 		assert(user);
 		user->notice(msg);
@@ -287,18 +324,19 @@ void session::handle_ping(const prefix& pfx,
                           const optional_string& server2) {
 	std::ostringstream oss;
 	oss << "PONG " << server1 << "\r\n";
-	connection_->write(oss.str());
+	//a late PONG gets us disconnected, never hold it back
+	connection_->write(oss.str(), write_priority::urgent);
 }
 
 void session::handle_join(const prefix& pfx,
                           const std::string& channel_name) {
-	if(pfx.nick) {
+	if(pfx.nick()) {
 		auto chan=get_or_create_channel(channel_name)->second;
 		auto user=get_or_create_user(pfx)->second;
 		assert(chan);
 		assert(user);
 		chan->user_join(user);
-		if(user->get_nick() == nickname_) { //is_me?
+		if(is_self(user->get_nick())) { //is_me?
 			on_join_channel(*chan);
 		}
 	}
@@ -315,34 +353,53 @@ void session::handle_part(const prefix& pfx,
 	assert(chan);
 	assert(user_p);
 
-	if(user_p->get_nick()==get_self().get_nick()) {
+	if(is_self(user_p->get_nick())) {
 		//we havea left a channel
-		auto ch_it=channels_.find(channel_name);
+		auto ch_it=channels_.find(key_for(channel_name));
 		//TODO: perhaps set warning if channel isn't even in list?
 		if(ch_it!=channels_.end()) {
+			auto key=ch_it->first;
+			//the members, part() forgets them
+			std::vector<shared_user> members(
+				ch_it->second->begin_users_impl().base(),
+				ch_it->second->end_users_impl().base());
 			ch_it->second->part();
+			//handlers may have changed the table, don't reuse ch_it
+			channels_.erase(key);
+
+			for(const auto& member : members)
+				forget_if_unshared(member);
 		}
-		channels_.erase(ch_it);
 	}
 	else {
 		//a user has left a channel
-
 		chan->user_part(user_p, msg);
-
-		users_.erase(user_it);
+		forget_if_unshared(user_p);
 	}
 }
 
+void session::forget_if_unshared(const shared_user& user) {
+	//no longer in any channel we share, stop tracking them
+	if(!user->get_channels_impl().empty() || is_self(user->get_nick()))
+		return;
+
+	auto it=users_.find(key_for(user->get_nick()));
+	//handlers may have renamed or replaced them
+	if(it != users_.end() && it->second == user)
+		users_.erase(it);
+}
+
 void session::handle_quit(const prefix& pfx,
                           const std::string& msg) {
-	if(pfx.nick) {
-		auto user_it=get_or_create_user(pfx); //todo: optimise
-		auto user   =user_it->second;
+	if(pfx.nick()) {
+		auto user=get_or_create_user(pfx)->second;
 
-		for(auto& channel : channels_) {
-			channel.second->user_quit(user, msg);
+		//only the channels the user was in, copied as user_quit shrinks it
+		auto channels=user->get_channels_impl();
+		for(auto* channel : channels) {
+			channel->user_quit(user, msg);
 		}
-		users_.erase(user_it);
+		users_.erase(key_for(*pfx.nick()));
 	}
 	else {
 		on_protocol_error(
@@ -353,7 +410,7 @@ void session::handle_quit(const prefix& pfx,
 
 // numeric responses from the server
 void session::handle_reply(const prefix& pfx, command cmd, 
-                           const std::vector<std::string>& params) {
+                           const param_list& params) {
 
 	auto requires_n_params=[&](std::size_t n) {
 		if(params.size() != n) {
@@ -391,9 +448,7 @@ void session::handle_reply(const prefix& pfx, command cmd,
 		break;
 	case command::mode:
 		if(minimum_n_params(2)) {
-			std::string modes=params[1];
-			if(params.size() == 3) modes+=" " + params[2];
-			handle_mode(pfx, params[0], modes);
+			handle_mode(pfx, params);
 		}
 		break;
 	case command::nick: if(minimum_n_params(1)) {
@@ -438,6 +493,9 @@ void session::handle_reply(const prefix& pfx, command cmd,
 		if(!active_)
 			handle_connection_established();
 		break;
+	case command::RPL_BOUNCE: //RPL_ISUPPORT
+		handle_isupport(params);
+		break;
 	case command::RPL_MOTD:
 	{
 		std::ostringstream oss; //TODO optimise for size=1 case?
@@ -491,17 +549,17 @@ void session::handle_reply(const prefix& pfx, command cmd,
 		}
 		break;
 	default: {
-			auto cmd_as_string=to_string(cmd);
-			if(boost::starts_with(cmd_as_string, "ERR_")) {
+			const auto& info=get_command_info(cmd);
+			if(info.type == command_class::error) {
 				std::ostringstream oss;
-				oss << cmd_as_string;
+				oss << info.name;
 				if(!params.empty()) {
 					oss << ": ";
 					for(const auto& s : params) oss << s << " ";
 				}
 				on_irc_error(oss.str());
 			}
-			else if(boost::starts_with(cmd_as_string, "RPL_")) {
+			else if(info.type == command_class::reply) {
 				//TODO: on reply, maybe we don't care, as it basically suggests
 				//that what we asked was ok?
 			}
@@ -512,30 +570,96 @@ void session::handle_reply(const prefix& pfx, command cmd,
 
 
 void session::handle_mode(const prefix& pfx,
-                          const std::string& agent,
-                          const std::string& mode) {
-
-	mode_diff parsed_modes;
-	parsed_modes=parse_modes(mode);
+                          const param_list& params) {
+	//params: <target> <modes> [<arg>...]
+	static const mode_classes user_mode_classes=[] {
+		//user modes never take an argument
+		mode_classes mc;
+		mc.set_prefix("()");
+		mc.set_chanmodes("");
+		return mc;
+	}();
+
+	const auto& agent=params[0];
+	bool is_chan=is_channel(agent);
+	if(!parse_modes(is_chan ? mode_classes_ : user_mode_classes,
+	                params[1], params.cbegin()+2, params.cend(), mode_diff_)) {
+		std::ostringstream oss;
+		oss << "malformed MODE " << agent << " " << params[1];
+		on_protocol_error(oss.str());
+	}
 
-	if(is_channel(agent)) {
+	if(is_chan) {
 		auto chan=get_or_create_channel(agent)->second;
 		assert(chan);
 
-		chan->apply_mode_diff(pfx, std::move(parsed_modes));
+		chan->apply_mode_diff(pfx, mode_diff_);
 	}
 	else { //is user
 		auto& user=get_or_create_user(agent)->second;
 		assert(user);
 
-		user->get_modes().apply_mode_diff(pfx, parsed_modes);
+		user->get_modes().apply_mode_diff(pfx, mode_diff_);
 	}
 }
 
+void session::handle_isupport(const param_list& params) {
+	//params: <nick> <token>... :are supported by this server
+	if(params.size() < 3) return;
+	std::for_each(params.cbegin()+1, params.cend()-1,
+		[&](const std::string& token) {
+			mode_classes_.apply_isupport(token);
+
+			casemapping cm;
+			string_view value { token };
+			if(value.starts_with("CASEMAPPING=")
+			&& parse_casemapping(value.substr(12), cm)) {
+				set_casemapping(cm);
+			}
+		}
+	);
+}
+
 const std::string& session::get_nick() const {
 	return nickname_;
 }
 
+folded_key session::key_for(string_view name) const {
+	return folded_key { name, casemapping_ };
+}
+
+bool session::is_self(string_view nick) const {
+	return equal_folded(nick, nickname_, casemapping_);
+}
+
+void session::set_casemapping(casemapping cm) {
+	if(cm == casemapping_) return;
+	casemapping_=cm;
+
+	//rekey everything, names which now fold together are merged
+	channel_container channels;
+	for(auto& ch : channels_)
+		channels.emplace(key_for(ch.second->get_name()), std::move(ch.second));
+	channels_.swap(channels);
+
+	user_container users;
+	for(auto& usr : users_)
+		users.emplace(key_for(usr.second->get_nick()), std::move(usr.second));
+	users_.swap(users);
+}
+
+casemapping session::get_casemapping() const {
+	return casemapping_;
+}
+
+const message_tags& session::get_current_tags() const {
+	return current_tags_;
+}
+
+const mode_classes& session::get_mode_classes() const {
+	return mode_classes_;
+}
+
 
 user& session::get_self() {
 	//TODO: if user doesn't exist then make?
@@ -590,10 +714,11 @@ void session::async_join(const std::string& channel_name) {
 	oss << "JOIN " << channel_name << "\r\n";
 	connection_->write(oss.str());
 }
-void session::async_privmsg(const std::string& target, const std::string& msg) {
+void session::async_privmsg(const std::string& target, const std::string& msg,
+                            write_priority priority) {
 	std::ostringstream oss;
 	oss << "PRIVMSG " << target << " :" << msg << "\r\n";
-	connection_->write(oss.str());
+	connection_->write(oss.str(), priority);
 }
 
 
@@ -624,5 +749,75 @@ void session::stop() {
 	}
 }
 
+/*
+** thread safe interface
+*/
+
+session::write_handle::write_handle(std::shared_ptr<outbox> box,
+                                    boost::asio::io_service& io_service)
+:	outbox_     ( std::move(box) )
+,	io_service_ ( &io_service    )
+{	}
+
+void session::write_handle::post_write(std::string line, write_priority priority) {
+	//the session has gone, nobody would drain it
+	if(!outbox_->owner.load()) return;
+	outbox_->queue.push(pending_write { std::move(line), priority });
+	post_drain(outbox_, *io_service_);
+}
+
+void session::write_handle::post_privmsg(const std::string& target,
+                                         const std::string& msg,
+                                         write_priority priority) {
+	std::ostringstream oss;
+	oss << "PRIVMSG " << target << " :" << msg << "\r\n";
+	post_write(oss.str(), priority);
+}
+
+session::write_handle session::get_write_handle() const {
+	return write_handle { outbox_, connection_->get_io_service() };
+}
+
+void session::post_write(std::string line, write_priority priority) {
+	get_write_handle().post_write(std::move(line), priority);
+}
+
+void session::post_privmsg(const std::string& target, const std::string& msg,
+                           write_priority priority) {
+	get_write_handle().post_privmsg(target, msg, priority);
+}
+
+void session::post_drain(const std::shared_ptr<outbox>& box,
+                         boost::asio::io_service& io_service) {
+	//one drain in flight at a time, however many threads are queueing
+	if(box->drain_posted.exchange(true)) return;
+
+	io_service.post(
+		[box] {
+			if(session* owner=box->owner.load()) owner->drain_outbox();
+		}
+	);
+}
+
+void session::drain_outbox() {
+	//bounded so a busy producer can't hold up reading
+	constexpr std::size_t batch=64;
+
+	outbox_->drain_posted.store(false);
+	outbox_->queue.drain(
+		[this](pending_write pw) {
+			try {
+				connection_->write(std::move(pw.line), pw.priority);
+			}
+			catch(const std::exception& e) {
+				on_irc_error(e.what());
+			}
+		},
+		batch
+	);
+	//more left, or a push still linking in, come back for it
+	if(!outbox_->queue.empty()) post_drain(outbox_, connection_->get_io_service());
+}
+
 
 } //namespace irc
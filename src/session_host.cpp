@@ -0,0 +1,124 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "session_host.hpp"
+#include "persistant_connection.hpp"
+#include "session.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace irc {
+
+session_host::session_host(std::size_t threads) {
+	if(threads == 0) threads=std::max(1u, std::thread::hardware_concurrency());
+
+	workers_.reserve(threads);
+	for(std::size_t i=0; i!=threads; ++i) {
+		workers_.emplace_back(new worker);
+		worker& w=*workers_.back();
+		w.work.reset(new ba::io_service::work { w.io_service });
+		w.thread=std::thread { &session_host::run, std::ref(w) };
+	}
+}
+
+session_host::~session_host() {
+	for(auto& w : workers_) {
+		worker* wp=w.get();
+		//sessions disconnect as they go, their handlers then drain
+		wp->io_service.post([wp] { wp->sessions.clear(); });
+		wp->work.reset();
+	}
+	for(auto& w : workers_) {
+		w->thread.join();
+	}
+}
+
+void session_host::run(worker& w) {
+	for(;;) {
+		try {
+			while(w.io_service.run_one()) {
+				w.handlers.fetch_add(1, std::memory_order_relaxed);
+			}
+			return;
+		}
+		catch(const std::exception&) {
+			w.errors.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+session_host::worker& session_host::worker_for(session_id id) {
+	return *workers_[id % workers_.size()];
+}
+
+session_host::session_id session_host::add_session(session_factory make) {
+	auto least=std::min_element(workers_.begin(), workers_.end(),
+		[](const std::unique_ptr<worker>& a, const std::unique_ptr<worker>& b) {
+			return a->session_count.load(std::memory_order_relaxed)
+			     < b->session_count.load(std::memory_order_relaxed);
+		}
+	);
+	std::size_t index=least - workers_.begin();
+	worker* wp=least->get();
+	wp->session_count.fetch_add(1, std::memory_order_relaxed);
+
+	//ids are spread so the thread can be found from the id alone
+	session_id id=next_serial_.fetch_add(1) * workers_.size() + index;
+	wp->io_service.post(
+		[wp, id, make] {
+			std::unique_ptr<session> s;
+			try {
+				s=make(wp->io_service);
+			}
+			catch(const std::exception&) {
+				wp->errors.fetch_add(1, std::memory_order_relaxed);
+			}
+			if(s) wp->sessions.emplace(id, std::move(s));
+			else  wp->session_count.fetch_sub(1, std::memory_order_relaxed);
+		}
+	);
+	return id;
+}
+
+void session_host::remove_session(session_id id) {
+	worker* wp=&worker_for(id);
+	wp->io_service.post(
+		[wp, id] {
+			if(wp->sessions.erase(id) != 0)
+				wp->session_count.fetch_sub(1, std::memory_order_relaxed);
+		}
+	);
+}
+
+void session_host::post(session_id id, std::function<void(session&)> f) {
+	worker* wp=&worker_for(id);
+	wp->io_service.post(
+		[wp, id, f] {
+			auto it=wp->sessions.find(id);
+			if(it != wp->sessions.end()) f(*it->second);
+		}
+	);
+}
+
+std::size_t session_host::get_thread_count() const {
+	return workers_.size();
+}
+
+std::vector<session_host::thread_stats> session_host::get_stats() const {
+	std::vector<thread_stats> stats;
+	stats.reserve(workers_.size());
+	for(const auto& w : workers_) {
+		stats.push_back(thread_stats {
+			w->session_count.load(std::memory_order_relaxed),
+			w->handlers.load(std::memory_order_relaxed),
+			w->errors.load(std::memory_order_relaxed)
+		});
+	}
+	return stats;
+}
+
+} //namespace irc
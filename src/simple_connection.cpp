@@ -2,17 +2,68 @@
 #include "exception.hpp"
 
 #include <boost/asio/connect.hpp>
-#include <boost/asio/read_until.hpp>
 #include <boost/asio/write.hpp>
 
 namespace irc {
 
+//counts as an outstanding operation for as long as the handler holding
+//it exists, so the connection is released after the handler has run or
+//when an io_service being destroyed drops it without running it
+class simple_connection::op_guard {
+	simple_connection* conn_;
+public:
+	explicit op_guard(simple_connection& conn)
+	:	conn_ ( &conn )
+	{
+		conn_->begin_op();
+	}
+	op_guard(const op_guard& other)
+	:	conn_ ( other.conn_ )
+	{
+		if(conn_) conn_->begin_op();
+	}
+	op_guard(op_guard&& other) noexcept
+	:	conn_ ( other.conn_ )
+	{
+		other.conn_=nullptr;
+	}
+	op_guard& operator=(const op_guard&)=delete;
+
+	~op_guard() {
+		if(conn_) conn_->end_op();
+	}
+}; //class op_guard
+
+//marks lines as being dispatched, any handler set meanwhile is applied
+//on the way out, even if a handler throws
+struct simple_connection::dispatch_scope {
+	simple_connection& conn;
+	~dispatch_scope() {
+		conn.dispatching_=false;
+		conn.apply_pending_handler();
+	}
+};
+
 simple_connection::simple_connection(ba::io_service& io_service)
 :	io_service_ ( io_service )
 ,	resolver_   { io_service }
 ,	socket_     { io_service }
 {	}
 
+void simple_connection::begin_op() {
+	//the reference is only taken when going from idle to busy rather
+	//than once per operation
+	if(pending_++ == 0) self_=shared_from_this();
+}
+
+void simple_connection::end_op() {
+	assert(pending_ > 0);
+	if(--pending_ == 0) {
+		//may destroy this
+		auto self=std::move(self_);
+	}
+}
+
 void simple_connection::handle_connect(const boost::system::error_code& error,
                                        ba::ip::tcp::resolver::iterator iter) {
 	if(!error && is_ready()) { //else let it die?
@@ -42,9 +93,14 @@ void simple_connection::start_read() {
 
 void simple_connection::initiate_read() {
 	if(is_ready()) {
-		ba::async_read_until(socket_, streambuf_, delim_,
-			std::bind(&simple_connection::handle_read,
-				shared_from_this(), ph::_1, ph::_2));
+		op_guard guard { *this };
+		socket_.async_read_some(read_buffer_.prepare(),
+			make_alloc_handler(read_memory_,
+				[this, guard](const boost::system::error_code& error, std::size_t bytes) {
+					handle_read(error, bytes);
+				}
+			)
+		);
 	}//TODO: report if socket closed but is ative_
 }
 
@@ -56,12 +112,18 @@ void simple_connection::handle_read(const boost::system::error_code& error,
 		on_error(oss.str());
 	}
 	else if(is_ready()) {
-		//TODO: use the full delimiter
-		std::istream is { &streambuf_ };
-		std::string msg;
-		if(std::getline(is, msg)) { //deplete the stream
-			on_read(msg);
-		}
+		read_buffer_.commit(bytes_transferred);
+		//deliver every complete line we have, not just the first
+		dispatching_=true;
+		dispatch_scope scope { *this };
+		read_buffer_.consume_lines(
+			[this](string_view line) {
+				if(read_handler_) read_handler_(line);
+				apply_pending_handler();
+				on_read(line);
+				return is_ready();
+			}
+		);
 		initiate_read();
 	}
 }
@@ -70,45 +132,56 @@ void simple_connection::handle_read(const boost::system::error_code& error,
 void simple_connection::start(const std::string& hostname,
                               const std::string& service) {
 
-	auto this_sp=shared_from_this();
-
 	ba::ip::tcp::resolver::query query(hostname, service);
 
 	active_=true;
 
+	op_guard guard { *this };
 	resolver_.async_resolve(query,
-		//certain that "this" doesn't need to be captured in addition to this_sp
-		//TODO: passing "this in is a horendous hack for GCC
-		[this_sp, this](const boost::system::error_code& error,
-			ba::ip::tcp::resolver::iterator iter) {
-
-			if(error) {
-				std::ostringstream oss;
-				oss << "An error occured when trying to connect: " 
-				    << error.message();
-				this_sp->on_error(oss.str());
-				return;
-			}
-			else if(this_sp->active_) { //else let it die?
-				this_sp->on_resolve("Resolution completed");
-
-				ba::async_connect(this_sp->socket_, iter,
-					std::bind(&simple_connection::handle_connect,
-						this_sp, ph::_1, ph::_2));
+		make_alloc_handler(resolve_memory_,
+			[this, guard](const boost::system::error_code& error,
+				ba::ip::tcp::resolver::iterator iter) {
+
+				if(error) {
+					std::ostringstream oss;
+					oss << "An error occured when trying to connect: " 
+					    << error.message();
+					on_error(oss.str());
+					return;
+				}
+				else if(active_) { //else let it die?
+					on_resolve("Resolution completed");
+
+					op_guard connecting { *this };
+					ba::async_connect(socket_, iter,
+						make_alloc_handler(resolve_memory_,
+							[this, connecting](const boost::system::error_code& error,
+								ba::ip::tcp::resolver::iterator iter) {
+								handle_connect(error, iter);
+							}
+						)
+					);
+				}
 			}
-		}
+		)
 	);
 
 }
 
 void simple_connection::initiate_write() {
-	assert(!message_buffer_.empty() && "message_buffer should not be empty");
+	assert(!write_queue_.empty() && "write_queue should not be empty");
 
 	if(is_ready()) {
+		//everything queued goes out in one gathered write
+		op_guard guard { *this };
 		boost::asio::async_write(socket_,
-			boost::asio::buffer(message_buffer_.front()),
-			std::bind(&simple_connection::handle_write,
-				shared_from_this(), ph::_1, ph::_2));
+			write_queue_.prepare(),
+			make_alloc_handler(write_memory_,
+				[this, guard](const boost::system::error_code& error, std::size_t bytes) {
+					handle_write(error, bytes);
+				}
+			)
+		);
 	} //else die?
 }
 
@@ -121,8 +194,7 @@ void simple_connection::handle_write(const boost::system::error_code& error,
 		on_error(oss.str());
 	}
 	else {
-		message_buffer_.pop_front();
-		if(!message_buffer_.empty() && is_ready())
+		if(write_queue_.consume() && is_ready())
 			initiate_write();
 	}
 }
@@ -134,9 +206,8 @@ void simple_connection::write(std::string payload) {
 		throw IRC_MAKE_EXCEPTION(oss.str());
 	}
 	else {
-		bool go=message_buffer_.empty();
-		message_buffer_.push_back(std::move(payload));
-		if(go) initiate_write();
+		if(write_queue_.push(std::move(payload)))
+			initiate_write();
 	}
 }
 
@@ -152,4 +223,23 @@ bool simple_connection::is_ready() const {
 	return active_ && socket_.is_open();
 }
 
+void simple_connection::set_max_write_bytes(std::size_t max_bytes) {
+	write_queue_.set_max_bytes(max_bytes);
+}
+
+void simple_connection::set_read_handler(read_handler handler) {
+	if(dispatching_) {
+		pending_handler_=std::move(handler);
+		handler_pending_=true;
+	}
+	else read_handler_=std::move(handler);
+}
+
+void simple_connection::apply_pending_handler() {
+	if(!handler_pending_) return;
+	handler_pending_=false;
+	read_handler_=std::move(pending_handler_);
+	pending_handler_=nullptr;
+}
+
 } //namespace irc
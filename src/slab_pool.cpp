@@ -0,0 +1,79 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "slab_pool.hpp"
+
+#include <cassert>
+
+namespace irc {
+
+namespace {
+
+//blocks are padded so every one is suitably aligned
+std::size_t block_size(std::size_t size) {
+	constexpr std::size_t align=alignof(std::max_align_t);
+	if(size < sizeof(void*)) size=sizeof(void*);
+	return (size + align - 1) / align * align;
+}
+
+} //namespace
+
+slab_pool::slab_pool(std::size_t blocks_per_slab)
+:	blocks_per_slab_ ( blocks_per_slab )
+{
+	assert(blocks_per_slab > 0);
+}
+
+slab_pool::size_class& slab_pool::get_class(std::size_t size) {
+	size=block_size(size);
+	//only a handful of object types use a pool, a scan beats a map
+	for(auto& sc : classes_) {
+		if(sc.size == size) return sc;
+	}
+	classes_.push_back(size_class { size, nullptr });
+	return classes_.back();
+}
+
+void slab_pool::add_slab(size_class& sc) {
+	//operator new[] for char gives memory aligned for any fundamental type
+	std::unique_ptr<char[]> slab { new char[sc.size * blocks_per_slab_] };
+	char* first=slab.get();
+	for(std::size_t i=blocks_per_slab_; i-- != 0; ) {
+		auto* block=::new (first + i*sc.size) free_block;
+		block->next=sc.free;
+		sc.free=block;
+	}
+	slabs_.push_back(std::move(slab));
+}
+
+void* slab_pool::allocate(std::size_t size) {
+	auto& sc=get_class(size);
+	if(!sc.free) add_slab(sc);
+
+	free_block* block=sc.free;
+	sc.free=block->next;
+	++in_use_;
+	return block;
+}
+
+void slab_pool::deallocate(void* p, std::size_t size) {
+	if(!p) return;
+	auto& sc=get_class(size);
+	auto* block=::new (p) free_block;
+	block->next=sc.free;
+	sc.free=block;
+	--in_use_;
+}
+
+std::size_t slab_pool::in_use() const {
+	return in_use_;
+}
+
+std::size_t slab_pool::slab_count() const {
+	return slabs_.size();
+}
+
+} //namespace irc
@@ -7,6 +7,7 @@
 #include "user.hpp"
 #include "channel.hpp"
 
+#include <algorithm>
 #include <utility>
 
 namespace irc {
@@ -30,6 +31,8 @@ const prefix& user_impl::get_prefix_impl() const { return pfx_; }
 const mode_block& user_impl::get_modes_impl() const { return modes_; }
 mode_block& user_impl::get_modes_impl() { return modes_; }
 
+const user_impl::channel_list& user_impl::get_channels_impl() const { return channels_; }
+
 /*
 void user_impl::send_privmsg_impl(const std::string& msg) {
 	session_.async_privmsg(get_nick(), msg);
@@ -45,6 +48,20 @@ void user_impl::send_notice_impl(const std::string& msg) {
 /*
 ** System interface
 */
+void user_impl::add_channel(channel_impl& chan) {
+	assert(std::find(channels_.begin(), channels_.end(), &chan) == channels_.end());
+	channels_.push_back(&chan);
+}
+
+void user_impl::remove_channel(channel_impl& chan) {
+	auto it=std::find(channels_.begin(), channels_.end(), &chan);
+	if(it != channels_.end()) {
+		//order doesn't matter, swap with the back to avoid shifting
+		*it=channels_.back();
+		channels_.pop_back();
+	}
+}
+
 void user_impl::set_nick(std::string nick) {
 	nick_=std::move(nick);
 	on_nick_change(*this, nick_);
@@ -0,0 +1,75 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "write_queue.hpp"
+
+#include <cassert>
+#include <utility>
+
+namespace irc {
+
+constexpr std::size_t write_queue::default_max_bytes;
+
+write_queue::write_queue(std::size_t max_bytes)
+:	max_bytes_ { max_bytes }
+{	}
+
+bool write_queue::push(std::string msg) {
+	//deque::push_back doesn't move existing elements
+	//so the in flight buffers remain valid
+	messages_.push_back(std::move(msg));
+	return in_flight_ == 0;
+}
+
+const write_queue::buffer_sequence& write_queue::prepare() {
+	assert(in_flight_ == 0 && "a write is already in flight");
+	assert(!messages_.empty() && "nothing to write");
+
+	buffers_.clear();
+	std::size_t bytes=0;
+	for(const auto& msg : messages_) {
+		if(!buffers_.empty() && bytes + msg.size() > max_bytes_) break;
+		buffers_.push_back(boost::asio::buffer(msg));
+		bytes+=msg.size();
+	}
+	in_flight_=buffers_.size();
+	return buffers_;
+}
+
+bool write_queue::consume() {
+	assert(in_flight_ <= messages_.size());
+	messages_.erase(messages_.begin(), messages_.begin() + in_flight_);
+	in_flight_=0;
+	return !messages_.empty();
+}
+
+void write_queue::clear() {
+	messages_.clear();
+	buffers_.clear();
+	in_flight_=0;
+}
+
+bool write_queue::empty() const {
+	return messages_.empty();
+}
+
+std::size_t write_queue::size() const {
+	return messages_.size();
+}
+
+std::size_t write_queue::in_flight() const {
+	return in_flight_;
+}
+
+void write_queue::set_max_bytes(std::size_t max_bytes) {
+	max_bytes_=max_bytes;
+}
+
+std::size_t write_queue::get_max_bytes() const {
+	return max_bytes_;
+}
+
+} //namespace irc
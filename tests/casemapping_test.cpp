@@ -0,0 +1,51 @@
+#define BOOST_TEST_MODULE casemapping_test
+
+#include <casemapping.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <string>
+#include <unordered_map>
+
+int test_main(int, char **) {
+	using irc::casemapping;
+
+	casemapping cm=casemapping::ascii;
+	BOOST_CHECK(irc::parse_casemapping("rfc1459", cm) && cm == casemapping::rfc1459);
+	BOOST_CHECK(irc::parse_casemapping("strict-rfc1459", cm) && cm == casemapping::strict_rfc1459);
+	BOOST_CHECK(irc::parse_casemapping("ascii", cm) && cm == casemapping::ascii);
+	BOOST_CHECK(!irc::parse_casemapping("rfc7613", cm) && cm == casemapping::ascii);
+
+	BOOST_CHECK(irc::fold_case("Nick[]\\^", casemapping::ascii)          == "nick[]\\^");
+	BOOST_CHECK(irc::fold_case("Nick[]\\^", casemapping::rfc1459)        == "nick{}|~");
+	BOOST_CHECK(irc::fold_case("Nick[]\\^", casemapping::strict_rfc1459) == "nick{}|^");
+
+	//long enough for the vector path, with bytes above 0x7f left alone
+	std::string lng="#A-Very-Long-Channel-Name[WITH]\xc3\x89-Everything";
+	BOOST_CHECK(irc::fold_case(lng, casemapping::rfc1459)
+		== "#a-very-long-channel-name{with}\xc3\x89-everything");
+
+	BOOST_CHECK(irc::equal_folded("Nick[", "nick{", casemapping::rfc1459));
+	BOOST_CHECK(!irc::equal_folded("Nick[", "nick{", casemapping::ascii));
+	BOOST_CHECK(!irc::equal_folded("nick", "nick_", casemapping::rfc1459));
+
+	irc::folded_key a { "#Foo", casemapping::rfc1459 },
+	                b { "#foo", casemapping::rfc1459 },
+	                c { "#fop", casemapping::rfc1459 };
+	BOOST_CHECK(a == b);
+	BOOST_CHECK(a.hash() == b.hash());
+	BOOST_CHECK(a != c);
+	BOOST_CHECK(a.str() == "#foo");
+
+	irc::folded_key d { lng, casemapping::rfc1459 },
+	                e { irc::fold_case(lng, casemapping::rfc1459), casemapping::rfc1459 };
+	BOOST_CHECK(d == e);
+
+	std::unordered_map<irc::folded_key, int, irc::folded_key_hash> map;
+	map.emplace(irc::folded_key { "Nick[", casemapping::rfc1459 }, 1);
+	BOOST_CHECK(!map.emplace(irc::folded_key { "NICK{", casemapping::rfc1459 }, 2).second);
+	BOOST_CHECK(map.size() == 1);
+	BOOST_CHECK(map.count(irc::folded_key { "nick{", casemapping::rfc1459 }) == 1);
+
+	return 0;
+}
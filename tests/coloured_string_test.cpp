@@ -84,3 +84,84 @@ BOOST_AUTO_TEST_CASE(spaces) {
 	test_coloured_string(res[5], "", irc::colours::black, irc::colours::black);
 	test_coloured_string(res[6], " ", irc::colours::black, irc::colours::black);
 }
+
+BOOST_AUTO_TEST_CASE(modifiers) {
+	auto res=irc::parse_coloured_string("a\x02""b\x02""c\x02\x16""d\x0f""e");
+	BOOST_CHECK_EQUAL(res.size(), 6);
+
+	BOOST_CHECK(!res[0].get_bold());
+	BOOST_CHECK(res[1].get_bold());
+	BOOST_CHECK(!res[2].get_bold());
+	BOOST_CHECK_EQUAL(res[3].value, "");
+	BOOST_CHECK(res[3].get_bold());
+	BOOST_CHECK(res[4].get_bold());
+	BOOST_CHECK(res[4].get_reverse());
+	BOOST_CHECK_EQUAL(res[4].value, "d");
+	BOOST_CHECK(!res[5].get_bold());
+	BOOST_CHECK_EQUAL(res[5].value, "e");
+}
+
+BOOST_AUTO_TEST_CASE(reset) {
+	auto res=irc::parse_coloured_string("\x02\x03""4,2a\x0f""b");
+	BOOST_CHECK_EQUAL(res.size(), 3);
+	test_coloured_string(res[1], "a", irc::colours::red, irc::colours::blue);
+	BOOST_CHECK(res[1].get_bold());
+	test_coloured_string(res[2], "b", irc::colours::none, irc::colours::none);
+	BOOST_CHECK(!res[2].get_bold());
+	BOOST_CHECK(res[2].get_reset());
+}
+
+BOOST_AUTO_TEST_CASE(colour_digits) {
+	//two digits at most, a comma without a colour is text
+	auto res=irc::parse_coloured_string("\x03""123\x03""4,x\x03""99,01y");
+	BOOST_CHECK_EQUAL(res.size(), 3);
+	test_coloured_string(res[0], "3", irc::colours::light_blue, irc::colours::none);
+	test_coloured_string(res[1], ",x", irc::colours::red, irc::colours::none);
+	test_coloured_string(res[2], "y", irc::colours::none, irc::colours::black);
+}
+
+BOOST_AUTO_TEST_CASE(spans) {
+	std::string raw="the\x03""0quick\x03""brown";
+	std::vector<irc::text_span> spans;
+	BOOST_CHECK_EQUAL(irc::parse_coloured_string(raw, spans), 3);
+	BOOST_CHECK_EQUAL(spans[1].text, "quick");
+	BOOST_CHECK_EQUAL(spans[1].style.foreground, irc::colours::white);
+	//spans refer into the original string
+	BOOST_CHECK(spans[1].text.data() == raw.data() + 5);
+
+	irc::parse_coloured_string("plain", spans);
+	BOOST_CHECK_EQUAL(spans.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(visitor) {
+	std::string text;
+	std::size_t bold=0;
+	irc::visit_coloured_string("a\x02""b\x02""c",
+		[&](const irc::text_style& style, irc::string_view run) {
+			text.append(run.data(), run.size());
+			if(style.get_bold()) ++bold;
+		}
+	);
+	BOOST_CHECK_EQUAL(text, "abc");
+	BOOST_CHECK_EQUAL(bold, 1);
+}
+
+BOOST_AUTO_TEST_CASE(strip) {
+	BOOST_CHECK_EQUAL(irc::strip_formatting(""), "");
+	BOOST_CHECK_EQUAL(irc::strip_formatting("no formatting at all, long enough for a vector"),
+	                  "no formatting at all, long enough for a vector");
+	BOOST_CHECK_EQUAL(irc::strip_formatting("the\x03""0quick\x03""brown\x03""1,1fox\x03"),
+	                  "thequickbrownfox");
+	BOOST_CHECK_EQUAL(irc::strip_formatting("\x02""bold\x02 and \x03""04,12colour\x0f, a comma\x03"",x"),
+	                  "bold and colour, a comma,x");
+	//control characters past the first 16 bytes, other low bytes are kept
+	BOOST_CHECK_EQUAL(irc::strip_formatting("0123456789abcdef\x01xyz\x1f""0123456789abcdef\x16""end"),
+	                  "0123456789abcdef\x01xyz0123456789abcdefend");
+
+	std::string msg="\x03""4,2red on blue\x03 plain";
+	irc::strip_formatting(msg);
+	BOOST_CHECK_EQUAL(msg, "red on blue plain");
+
+	const char* text="a\x1f""b";
+	BOOST_CHECK(irc::find_formatting(text, text+3) == text+1);
+}
@@ -79,5 +79,10 @@ int test_main(int, char **) {
     BOOST_CHECK(cmd == ctcp::command::time);
     BOOST_CHECK(str == ":Thu Aug 11 21:52:51 1994 CST");
 
+    BOOST_CHECK(ctcp::to_command("ACTION")  == ctcp::command::action);
+    BOOST_CHECK(ctcp::to_command("VERSION") == ctcp::command::version);
+    BOOST_CHECK(ctcp::to_command("action")  == ctcp::command::none);
+    BOOST_CHECK(ctcp::to_command("")        == ctcp::command::none);
+
     return 0;
 }
@@ -0,0 +1,78 @@
+#define BOOST_TEST_MODULE flat_hash_test
+
+#include <flat_hash.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+//every key in one bucket, so probing and erasing shift entries around
+struct collide {
+	std::size_t operator()(int) const { return 0; }
+};
+
+int test_main(int, char **) {
+	irc::flat_hash_map<std::string, int> map;
+	BOOST_CHECK(map.empty());
+	BOOST_CHECK(map.begin() == map.end());
+	BOOST_CHECK(map.find("a") == map.end());
+
+	BOOST_CHECK(map.emplace("a", 1).second);
+	BOOST_CHECK(!map.emplace("a", 2).second);
+	BOOST_CHECK(map.find("a")->second == 1);
+	map["b"]=2;
+	BOOST_CHECK(map.size() == 2);
+	BOOST_CHECK(map.count("b") == 1);
+	BOOST_CHECK(map.erase("a") == 1);
+	BOOST_CHECK(map.erase("a") == 0);
+	BOOST_CHECK(map.size() == 1);
+
+	//grow well past the first table and check against a reference
+	std::unordered_map<std::string, int> ref;
+	for(int i=0; i!=5000; ++i) {
+		map.emplace(std::to_string(i), i);
+		ref.emplace(std::to_string(i), i);
+	}
+	for(int i=0; i<5000; i+=3) {
+		map.erase(std::to_string(i));
+		ref.erase(std::to_string(i));
+	}
+	ref.emplace("b", 2);
+	BOOST_CHECK(map.size() == ref.size());
+	std::size_t seen=0;
+	for(const auto& kv : map) {
+		auto it=ref.find(kv.first);
+		BOOST_CHECK(it != ref.end() && it->second == kv.second);
+		++seen;
+	}
+	BOOST_CHECK(seen == ref.size());
+
+	irc::flat_hash_map<int, int, collide> worst;
+	for(int i=0; i!=10; ++i) worst.emplace(i, i*10);
+	worst.erase(0);
+	worst.erase(5);
+	for(int i=0; i!=10; ++i) {
+		auto it=worst.find(i);
+		BOOST_CHECK((i == 0 || i == 5) ? it == worst.end() : it->second == i*10);
+	}
+
+	irc::flat_hash_set<std::shared_ptr<int>> set;
+	auto p=std::make_shared<int>(1), q=std::make_shared<int>(2);
+	BOOST_CHECK(set.insert(p).second);
+	BOOST_CHECK(!set.insert(p).second);
+	BOOST_CHECK(set.insert(q).second);
+	set.erase(set.find(p));
+	BOOST_CHECK(set.size() == 1);
+	BOOST_CHECK(*set.begin() == q);
+	BOOST_CHECK(p.use_count() == 1);
+
+	irc::flat_hash_set<std::shared_ptr<int>> other;
+	other.swap(set);
+	BOOST_CHECK(set.empty() && other.size() == 1);
+	other.clear();
+	BOOST_CHECK(q.use_count() == 1);
+
+	return 0;
+}
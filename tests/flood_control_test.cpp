@@ -0,0 +1,97 @@
+#include "loopback_server.hpp"
+
+#include <flood_control.hpp>
+#include <persistant_connection.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+int test_main(int, char**) {
+	auto start=irc::flood_control::clock::now();
+	irc::flood_limits limits;
+	limits.lines =2;
+	limits.bytes =0;
+	limits.window=milliseconds { 1000 };
+
+	irc::flood_control fc { limits, start };
+	std::vector<std::string> sent;
+	auto send=[&](std::string msg) { sent.push_back(std::move(msg)); };
+
+	fc.push("PRIVMSG #a :1", irc::write_priority::bulk);
+	fc.push("PRIVMSG #a :2", irc::write_priority::bulk);
+	fc.push("PRIVMSG #a :3", irc::write_priority::bulk);
+	fc.push("PONG :server",  irc::write_priority::urgent);
+
+	//urgent first, it uses up budget but is never held back
+	BOOST_CHECK(fc.drain(start, send) == 2);
+	BOOST_CHECK(sent.size() == 2);
+	BOOST_CHECK(sent[0] == "PONG :server");
+	BOOST_CHECK(sent[1] == "PRIVMSG #a :1");
+	BOOST_CHECK(fc.queue_depth() == 2);
+	BOOST_CHECK(fc.queue_depth(irc::write_priority::bulk) == 2);
+
+	//one line is regained every 500ms
+	BOOST_CHECK(fc.next_ready(start) == milliseconds { 500 });
+	BOOST_CHECK(fc.expected_drain_time(start) == milliseconds { 1000 });
+
+	//a new normal message jumps the waiting bulk ones
+	fc.push("PRIVMSG #b :hi", irc::write_priority::normal);
+	BOOST_CHECK(fc.drain(start + milliseconds { 500 }, send) == 1);
+	BOOST_CHECK(sent.back() == "PRIVMSG #b :hi");
+
+	BOOST_CHECK(fc.drain(start + milliseconds { 2000 }, send) == 2);
+	BOOST_CHECK(sent.back() == "PRIVMSG #a :3");
+	BOOST_CHECK(fc.queue_depth() == 0);
+	BOOST_CHECK(fc.next_ready(start) == irc::flood_control::duration::zero());
+
+	//byte budget
+	limits.lines=0;
+	limits.bytes=10;
+	irc::flood_control bytes { limits, start };
+	bytes.push("123456", irc::write_priority::normal);
+	bytes.push("123456", irc::write_priority::normal);
+	BOOST_CHECK(bytes.drain(start, send) == 1);
+	BOOST_CHECK(bytes.next_ready(start) == milliseconds { 200 });
+
+	//lanes below lowest wait, as writes do before registration
+	limits.bytes=0;
+	irc::flood_control held { limits, start };
+	held.push("PRIVMSG #a :later", irc::write_priority::normal);
+	held.push("NICK me",           irc::write_priority::urgent);
+	sent.clear();
+	BOOST_CHECK(held.drain(start, send, irc::write_priority::urgent) == 1);
+	BOOST_CHECK(sent.back() == "NICK me");
+	BOOST_CHECK(held.queue_depth() == 1);
+	BOOST_CHECK(held.drain(start, send) == 1);
+	BOOST_CHECK(sent.back() == "PRIVMSG #a :later");
+
+	//a flush already due when the connection is destroyed is dropped
+	irc::test::loopback_server server;
+	boost::asio::io_service io_service;
+	boost::asio::io_service::work work { io_service };
+	std::unique_ptr<irc::persistant_connection> conn {
+		new irc::persistant_connection { io_service, "127.0.0.1", server.port() } };
+	limits.lines =1;
+	limits.bytes =0;
+	limits.window=milliseconds { 20 };
+	conn->set_flood_limits(limits);
+	BOOST_CHECK(irc::test::run_until(io_service, [&] { return conn->is_ready(); }));
+	conn->write("PRIVMSG #a :now\r\n");
+	conn->write("PRIVMSG #a :never\r\n");
+	BOOST_CHECK(irc::test::run_until(io_service,
+		[&] { return server.received().size() == 1; }));
+	irc::test::destroy_with_timers_due(io_service, conn, milliseconds { 50 });
+	BOOST_CHECK(!conn);
+	io_service.poll();
+	std::this_thread::sleep_for(milliseconds { 50 });
+	BOOST_CHECK(server.received().size() == 1);
+
+	return 0;
+}
@@ -0,0 +1,65 @@
+#define BOOST_TEST_MODULE handler_allocator_test
+
+#include <handler_allocator.hpp>
+#include <simple_connection.hpp>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/test/minimal.hpp>
+
+#include <memory>
+#include <string>
+
+int test_main(int, char **) {
+	irc::handler_memory memory;
+	BOOST_CHECK(!memory.in_use());
+
+	void* block=memory.allocate(64);
+	BOOST_CHECK(memory.in_use());
+	//the block is taken so this comes from the heap
+	void* other=memory.allocate(64);
+	BOOST_CHECK(other != block);
+	memory.deallocate(other);
+	BOOST_CHECK(memory.in_use());
+	memory.deallocate(block);
+	BOOST_CHECK(!memory.in_use());
+	BOOST_CHECK(memory.allocate(32) == block);
+	memory.deallocate(block);
+
+	//too big for the block
+	void* big=memory.allocate(4096);
+	BOOST_CHECK(big != block);
+	BOOST_CHECK(!memory.in_use());
+	memory.deallocate(big);
+
+	//asio takes the operation from the block and gives it back before
+	//the handler runs, so a handler can start the next operation
+	boost::asio::io_service io_service;
+	int runs=0;
+	std::string payload="kept alive by the handler";
+	io_service.post(irc::make_alloc_handler(memory,
+		[&, payload]() {
+			BOOST_CHECK(!memory.in_use());
+			BOOST_CHECK(payload == "kept alive by the handler");
+			++runs;
+		}
+	));
+	BOOST_CHECK(memory.in_use());
+	io_service.run();
+	BOOST_CHECK(runs == 1);
+	BOOST_CHECK(!memory.in_use());
+
+	//a connection is kept alive by its outstanding handlers, which
+	//still let it go if they are destroyed without being run
+	std::weak_ptr<irc::simple_connection> watch;
+	{
+		boost::asio::io_service io_service;
+		auto conn=std::make_shared<irc::simple_connection>(io_service);
+		conn->start("127.0.0.1", "6667");
+		watch=conn;
+		conn.reset();
+		BOOST_CHECK(!watch.expired());
+	}
+	BOOST_CHECK(watch.expired());
+
+	return 0;
+}
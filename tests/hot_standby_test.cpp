@@ -0,0 +1,187 @@
+#include "loopback_server.hpp"
+
+#include <persistant_connection.hpp>
+#include <session.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ba=boost::asio;
+
+namespace {
+
+using irc::test::loopback_server;
+using irc::test::run_until;
+
+//fails the first connection and returns how long it took to replace it
+irc::persistant_connection::duration measure_failover(
+		ba::io_service& io_service, loopback_server& server, bool hot_standby) {
+	//polling an io_service with nothing to do would stop it
+	ba::io_service::work work { io_service };
+	irc::persistant_connection conn { io_service, "127.0.0.1", server.port() };
+	conn.set_hot_standby(hot_standby);
+	//measure the reconnect itself, not the spread before it
+	irc::reconnect_policy policy;
+	policy.first_spread=std::chrono::milliseconds { 0 };
+	conn.set_reconnect_policy(policy);
+
+	int connects=0;
+	std::vector<std::string> lines;
+	conn.connect_on_connect([&](const std::string&) { ++connects; });
+	conn.set_read_handler(
+		[&](irc::string_view line) { lines.emplace_back(line.data(), line.size()); });
+
+	BOOST_CHECK(run_until(io_service, [&] { return connects == 1; }));
+	conn.start_read();
+	BOOST_CHECK(run_until(io_service, [&] { return lines.size() == 1; }));
+	if(hot_standby) {
+		BOOST_CHECK(run_until(io_service, [&] { return conn.has_standby(); }));
+	}
+	BOOST_CHECK(!conn.get_last_failover_time());
+
+	server.close(0);
+	BOOST_CHECK(run_until(io_service, [&] { return connects == 2; }));
+	//the new connection is read without being asked again,
+	//a standby hands over what it was greeted with
+	BOOST_CHECK(run_until(io_service, [&] { return lines.size() == 2; }));
+	BOOST_CHECK(lines.back() == ":srv NOTICE * :hello");
+	BOOST_CHECK(conn.is_ready());
+	if(hot_standby) {
+		//and a new standby takes its place
+		BOOST_CHECK(run_until(io_service, [&] { return conn.has_standby(); }));
+	}
+
+	BOOST_CHECK(conn.get_last_failover_time());
+	return conn.get_last_failover_time().get_value_or({ });
+}
+
+irc::persistant_connection::duration failover(bool hot_standby) {
+	loopback_server server { ":srv NOTICE * :hello\r\n" };
+	ba::io_service io_service;
+	return measure_failover(io_service, server, hot_standby);
+}
+
+//a session registers the promoted standby and rejoins its channels,
+//returns how long until it was welcomed again
+irc::persistant_connection::duration session_failover() {
+	loopback_server server { "", irc::test::welcome };
+	ba::io_service io_service;
+	ba::io_service::work work { io_service };
+
+	std::unique_ptr<irc::persistant_connection> owned {
+		new irc::persistant_connection { io_service, "127.0.0.1", server.port() } };
+	irc::persistant_connection& conn=*owned;
+	conn.set_hot_standby(true);
+	irc::session s { std::move(owned), "me", "user", "real" };
+
+	int established=0;
+	s.connect_on_connection_established([&] { ++established; });
+	BOOST_CHECK(run_until(io_service,
+		[&] { return established == 1 && conn.has_standby(); }));
+
+	server.send(0, ":me!u@h JOIN #a\r\n");
+	BOOST_CHECK(run_until(io_service,
+		[&] { return s.channel_begin() != s.channel_end(); }));
+
+	server.close(0);
+	BOOST_CHECK(run_until(io_service, [&] { return established == 2; }));
+	BOOST_CHECK(conn.is_established());
+
+	//NICK then JOIN went to the standby, after it was promoted
+	auto sent_to_standby=[&] {
+		std::size_t nicks=0, joins=0;
+		for(auto& line : server.received()) {
+			if(line == "NICK me")           ++nicks;
+			if(line == "JOIN #a" && nicks == 2) ++joins;
+		}
+		return joins;
+	};
+	BOOST_CHECK(run_until(io_service, [&] { return sent_to_standby() == 1; }));
+
+	BOOST_CHECK(conn.get_last_failover_time());
+	return conn.get_last_failover_time().get_value_or({ });
+}
+
+//a standby reopen already due when the connection is destroyed is dropped
+void standby_due_on_destroy() {
+	loopback_server server;
+	ba::io_service io_service;
+	ba::io_service::work work { io_service };
+
+	std::unique_ptr<irc::persistant_connection> conn {
+		new irc::persistant_connection { io_service, "127.0.0.1", server.port() } };
+	irc::reconnect_policy policy;
+	policy.first_delay =std::chrono::milliseconds { 20 };
+	policy.first_spread=std::chrono::milliseconds { 0 };
+	conn->set_reconnect_policy(policy);
+	conn->set_hot_standby(true);
+	BOOST_CHECK(run_until(io_service, [&] { return conn->has_standby(); }));
+
+	server.close(1);
+	BOOST_CHECK(run_until(io_service, [&] { return !conn->has_standby(); }));
+	irc::test::destroy_with_timers_due(io_service, conn, std::chrono::milliseconds { 50 });
+	BOOST_CHECK(!conn);
+	io_service.poll();
+	std::this_thread::sleep_for(std::chrono::milliseconds { 50 });
+	BOOST_CHECK(server.accepted() == 2);
+}
+
+//a standby lost over and over is reopened later each time
+void standby_backoff() {
+	using std::chrono::milliseconds;
+	loopback_server server;
+	ba::io_service io_service;
+	ba::io_service::work work { io_service };
+
+	irc::persistant_connection conn { io_service, "127.0.0.1", server.port() };
+	irc::reconnect_policy policy;
+	policy.first_delay =milliseconds { 0 };
+	policy.first_spread=milliseconds { 0 };
+	policy.base_delay  =milliseconds { 40 };
+	policy.multiplier  =2;
+	policy.jitter      =0;
+	conn.set_reconnect_policy(policy);
+	conn.set_hot_standby(true);
+	BOOST_CHECK(run_until(io_service, [&] { return conn.has_standby(); }));
+
+	//waits 0, 40 then 80ms
+	irc::persistant_connection::duration gap { };
+	for(std::size_t i=1; i!=4; ++i) {
+		auto lost=irc::persistant_connection::clock::now();
+		server.close(i);
+		BOOST_CHECK(run_until(io_service,
+			[&] { return server.accepted() == i + 2 && conn.has_standby(); }));
+		gap=irc::persistant_connection::clock::now() - lost;
+	}
+	BOOST_CHECK(gap >= milliseconds { 75 });
+}
+
+} //namespace
+
+int test_main(int, char**) {
+	using std::chrono::microseconds;
+	using std::chrono::duration_cast;
+
+	auto reconnect=failover(false);
+	auto promoted =failover(true);
+	std::cout << "failover by reconnecting: "
+	          << duration_cast<microseconds>(reconnect).count() << "us\n"
+	          << "failover to hot standby:  "
+	          << duration_cast<microseconds>(promoted).count()  << "us\n";
+	BOOST_CHECK(promoted < reconnect);
+
+	auto registered=session_failover();
+	std::cout << "until the session is welcomed again: "
+	          << duration_cast<microseconds>(registered).count() << "us\n";
+
+	standby_due_on_destroy();
+	standby_backoff();
+
+	return 0;
+}
@@ -0,0 +1,77 @@
+#define BOOST_TEST_MODULE light_signal_test
+
+#include <light_signal.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <string>
+#include <vector>
+
+int test_main(int, char **) {
+	irc::light_signal<void(const std::string&)> sig;
+	BOOST_CHECK(sig.empty());
+	sig("nobody listening");
+
+	std::vector<std::string> seen;
+	auto c1=sig.connect([&](const std::string& s) { seen.push_back("a" + s); });
+	auto c2=sig.connect([&](const std::string& s) { seen.push_back("b" + s); });
+	BOOST_CHECK(!sig.empty());
+	BOOST_CHECK(c1.connected());
+
+	sig("1");
+	BOOST_CHECK(seen.size() == 2);
+	BOOST_CHECK(seen[0] == "a1");
+	BOOST_CHECK(seen[1] == "b1");
+
+	c1.disconnect();
+	BOOST_CHECK(!c1.connected());
+	seen.clear();
+	sig("2");
+	BOOST_CHECK(seen.size() == 1);
+	BOOST_CHECK(seen[0] == "b2");
+
+	//a slot disconnecting itself and connecting another mid emit
+	irc::light_connection self;
+	int calls=0, late=0;
+	self=sig.connect([&](const std::string&) {
+		++calls;
+		self.disconnect();
+		sig.connect([&](const std::string&) { ++late; });
+	});
+	sig("3");
+	BOOST_CHECK(calls == 1);
+	BOOST_CHECK(late == 0);
+	sig("4");
+	BOOST_CHECK(calls == 1);
+	BOOST_CHECK(late == 1);
+
+	sig.disconnect_all_slots();
+	BOOST_CHECK(sig.empty());
+	BOOST_CHECK(!c2.connected());
+
+	//disconnecting after the signal has gone is harmless
+	irc::light_connection orphan;
+	{
+		irc::light_signal<void()> gone;
+		orphan=gone.connect([] { });
+	}
+	BOOST_CHECK(!orphan.connected());
+	orphan.disconnect();
+
+	//non void signals give the last result
+	irc::light_signal<std::string(const std::string&)> gen;
+	BOOST_CHECK(!gen("nick"));
+	gen.connect([](const std::string& s) { return s + "_"; });
+	gen.connect([](const std::string& s) { return s + "^"; });
+	BOOST_CHECK(*gen("nick") == "nick^");
+
+	//chaining one signal onto another
+	irc::light_signal<void(int)> outer, inner;
+	int total=0;
+	inner.connect([&](int i) { total+=i; });
+	outer.connect(inner);
+	outer(5);
+	BOOST_CHECK(total == 5);
+
+	return 0;
+}
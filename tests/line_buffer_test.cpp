@@ -0,0 +1,70 @@
+#include <line_buffer.hpp>
+
+#include <boost/asio/buffer.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ba=boost::asio;
+
+void fill(irc::line_buffer& lb, const std::string& str) {
+	auto buf=lb.prepare();
+	BOOST_REQUIRE(ba::buffer_size(buf) >= str.size());
+	std::copy(str.begin(), str.end(), ba::buffer_cast<char*>(buf));
+	lb.commit(str.size());
+}
+
+int test_main(int, char**) {
+	//scan both the vectorised and the scalar paths
+	std::string line(40, 'x');
+	const char* first=line.data();
+	BOOST_CHECK(irc::find_line_end(first, first+line.size()) == first+line.size());
+	line[33]='\n';
+	BOOST_CHECK(irc::find_line_end(first, first+line.size()) == first+33);
+	line[3]='\n';
+	BOOST_CHECK(irc::find_line_end(first, first+line.size()) == first+3);
+
+	irc::line_buffer lb { 64 };
+	std::vector<std::string> lines;
+	auto collect=[&](irc::string_view sv) {
+		lines.push_back(sv.to_string());
+		return true;
+	};
+
+	fill(lb, "PING :a\r\nPING :b\r\nPING :c\r\nPRIV");
+	BOOST_CHECK(lb.consume_lines(collect) == 3);
+	BOOST_CHECK(lines.size() == 3);
+	BOOST_CHECK(lines[0] == "PING :a");
+	BOOST_CHECK(lines[2] == "PING :c");
+	//the partial line is kept for the next read
+	BOOST_CHECK(lb.size() == 4);
+
+	fill(lb, "MSG #a :hi\n");
+	BOOST_CHECK(lb.consume_lines(collect) == 1);
+	BOOST_CHECK(lines.back() == "PRIVMSG #a :hi");
+	BOOST_CHECK(lb.size() == 0);
+
+	//stopping early keeps the remaining lines
+	lines.clear();
+	fill(lb, "a\r\nb\r\nc\r\n");
+	BOOST_CHECK(lb.consume_lines([&](irc::string_view sv) {
+		lines.push_back(sv.to_string());
+		return false;
+	}) == 1);
+	BOOST_CHECK(lb.consume_lines(collect) == 2);
+	BOOST_CHECK(lines.size() == 3 && lines[2] == "c");
+
+	//lines longer than the buffer grow it
+	std::string long_line(200, 'y');
+	for(std::size_t i=0; i<long_line.size(); i+=32)
+		fill(lb, long_line.substr(i, 32));
+	fill(lb, "\r\n");
+	lines.clear();
+	BOOST_CHECK(lb.consume_lines(collect) == 1);
+	BOOST_CHECK(lines[0] == long_line);
+
+	return 0;
+}
@@ -0,0 +1,219 @@
+
+//          Copyright Joseph Dobson 2014
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef IRC_TESTS_LOOPBACK_SERVER_HPP
+#define IRC_TESTS_LOOPBACK_SERVER_HPP
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace irc {
+namespace test {
+
+namespace ba=boost::asio;
+
+/**
+ * A server on the loopback interface, running on its own thread
+ *
+ * It accepts every connection, sends each the greeting and records the
+ * lines they send, anything the responder returns for a line is sent
+ * back. Clients are numbered in the order they were accepted.
+ */
+class loopback_server {
+public:
+	using responder=std::function<std::string(const std::string& line)>;
+private:
+	struct client {
+		ba::ip::tcp::socket socket;
+		ba::streambuf       buffer;
+
+		explicit client(ba::io_service& io_service)
+		:	socket ( io_service )
+		{	}
+	}; //struct client
+
+	ba::io_service                       io_service_;
+	ba::ip::tcp::acceptor                acceptor_;
+	std::string                          greeting_;
+	responder                            respond_;
+	//only touched on the server's thread
+	std::vector<std::shared_ptr<client>> clients_;
+	std::atomic<std::size_t>             accepted_ { 0 };
+	mutable std::mutex                   mutex_;
+	std::vector<std::string>             received_;
+	std::thread                          thread_;
+
+	void accept() {
+		auto c=std::make_shared<client>(io_service_);
+		acceptor_.async_accept(c->socket,
+			[this, c](const boost::system::error_code& error) {
+				if(error) return;
+				clients_.push_back(c);
+				++accepted_;
+				if(!greeting_.empty()) write(*c, greeting_);
+				read(c);
+				accept();
+			}
+		);
+	}
+
+	void read(std::shared_ptr<client> c) {
+		ba::async_read_until(c->socket, c->buffer, '\n',
+			[this, c](const boost::system::error_code& error, std::size_t) {
+				if(error) return;
+				std::istream is { &c->buffer };
+				std::string line;
+				std::getline(is, line);
+				if(!line.empty() && line.back() == '\r') line.pop_back();
+				if(respond_) {
+					auto reply=respond_(line);
+					if(!reply.empty()) write(*c, reply);
+				}
+				{
+					std::lock_guard<std::mutex> lock { mutex_ };
+					received_.push_back(std::move(line));
+				}
+				read(c);
+			}
+		);
+	}
+
+	static void write(client& c, const std::string& data) {
+		auto payload=std::make_shared<std::string>(data);
+		ba::async_write(c.socket, ba::buffer(*payload),
+			[payload](const boost::system::error_code&, std::size_t) { });
+	}
+public:
+	explicit loopback_server(std::string greeting=std::string { },
+	                         responder respond=responder { })
+	:	acceptor_ { io_service_,
+			ba::ip::tcp::endpoint { ba::ip::address_v4::loopback(), 0 } }
+	,	greeting_ ( std::move(greeting) )
+	,	respond_  ( std::move(respond)  )
+	{
+		accept();
+		thread_=std::thread { [this] { io_service_.run(); } };
+	}
+	~loopback_server() {
+		io_service_.stop();
+		thread_.join();
+	}
+
+	std::string port() const {
+		return std::to_string(acceptor_.local_endpoint().port());
+	}
+
+	/**
+	 * @return how many connections have been accepted
+	 */
+	std::size_t accepted() const {
+		return accepted_;
+	}
+
+	/**
+	 * sends data to the nth client accepted
+	 */
+	void send(std::size_t n, std::string data) {
+		io_service_.post(
+			[this, n, data] {
+				if(n < clients_.size()) write(*clients_[n], data);
+			}
+		);
+	}
+
+	/**
+	 * closes the nth client accepted
+	 */
+	void close(std::size_t n) {
+		io_service_.post(
+			[this, n] {
+				if(n >= clients_.size()) return;
+				boost::system::error_code error;
+				clients_[n]->socket.shutdown(ba::ip::tcp::socket::shutdown_both, error);
+				clients_[n]->socket.close(error);
+			}
+		);
+	}
+
+	/**
+	 * @return every line received so far, from any client
+	 */
+	std::vector<std::string> received() const {
+		std::lock_guard<std::mutex> lock { mutex_ };
+		return received_;
+	}
+}; //class loopback_server
+
+/**
+ * A responder which welcomes every client as it sends NICK, so sessions
+ * register
+ */
+inline std::string welcome(const std::string& line) {
+	if(line.compare(0, 5, "NICK ") != 0) return { };
+	return ":srv 001 " + line.substr(5) + " :Welcome\r\n";
+}
+
+/**
+ * Waits on another thread, up to five seconds, for pred to hold.
+ */
+template<typename Pred>
+bool wait_for(Pred pred) {
+	for(int i=0; i!=5000; ++i) {
+		if(pred()) return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+/**
+ * Runs the handlers ready on io_service, up to five seconds, until pred
+ * holds. The io_service needs outstanding work or it stops.
+ */
+template<typename Pred>
+bool run_until(ba::io_service& io_service, Pred pred) {
+	for(int i=0; i!=5000; ++i) {
+		io_service.poll();
+		if(pred()) return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+/**
+ * Destroys p from a timer which completes in the same pass as every
+ * timer already due on io_service, so their handlers are queued to run
+ * with success after it has gone. Waits for them to come due first.
+ */
+template<typename T>
+void destroy_with_timers_due(ba::io_service& io_service, std::unique_ptr<T>& p,
+                             std::chrono::milliseconds due_within) {
+	ba::steady_timer reaper { io_service };
+	//earlier than anything else, so it runs first
+	reaper.expires_at(ba::steady_timer::clock_type::now() - std::chrono::hours(1));
+	reaper.async_wait([&p](const boost::system::error_code&) { p.reset(); });
+	std::this_thread::sleep_for(due_within);
+	io_service.poll();
+}
+
+} //namespace test
+} //namespace irc
+
+#endif //IRC_TESTS_LOOPBACK_SERVER_HPP
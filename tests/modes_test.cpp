@@ -0,0 +1,91 @@
+#define BOOST_TEST_MODULE modes_test
+
+#include <modes.hpp>
+#include <prefix.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <string>
+#include <vector>
+
+int test_main(int, char **) {
+	irc::mode_classes classes;
+	irc::mode_diff    md;
+
+	//RFC 2811 defaults
+	BOOST_CHECK(classes.get_type('o') == irc::mode_type::membership);
+	BOOST_CHECK(classes.get_type('b') == irc::mode_type::list);
+	BOOST_CHECK(classes.get_type('k') == irc::mode_type::always);
+	BOOST_CHECK(classes.get_type('l') == irc::mode_type::on_set);
+	BOOST_CHECK(classes.get_type('n') == irc::mode_type::flag);
+	BOOST_CHECK(classes.mode_for_symbol('@') == 'o');
+	BOOST_CHECK(classes.mode_for_symbol('!') == '\0');
+
+	std::vector<std::string> args { "alice", "bob" };
+	BOOST_CHECK(irc::parse_modes(classes, "+o-v", args.begin(), args.end(), md));
+	BOOST_CHECK(md.set.size() == 1);
+	BOOST_CHECK(md.set[0].first == 'o');
+	BOOST_CHECK(*md.set[0].second == "alice");
+	BOOST_CHECK(md.unset.size() == 1);
+	BOOST_CHECK(md.unset[0].first == 'v');
+	BOOST_CHECK(*md.unset[0].second == "bob");
+
+	//l only takes an argument when set, n never does
+	args={ "10", "*!*@spam" };
+	BOOST_CHECK(irc::parse_modes(classes, "+nl-l+b", args.begin(), args.end(), md));
+	BOOST_CHECK(md.set.size() == 3);
+	BOOST_CHECK(!md.set[0].second);
+	BOOST_CHECK(*md.set[1].second == "10");
+	BOOST_CHECK(*md.set[2].second == "*!*@spam");
+	BOOST_CHECK(md.unset.size() == 1);
+	BOOST_CHECK(!md.unset[0].second);
+	BOOST_CHECK(irc::to_string(md) == "+nl(10)b(*!*@spam)-l");
+
+	//missing arguments and missing signs are reported
+	args.clear();
+	BOOST_CHECK(!irc::parse_modes(classes, "+k", args.begin(), args.end(), md));
+	BOOST_CHECK(md.set.size() == 1);
+	BOOST_CHECK(!irc::parse_modes(classes, "k", args.begin(), args.end(), md));
+
+	//server supplied classes
+	classes.apply_isupport("PREFIX=(qaohv)~&@%+");
+	classes.apply_isupport("CHANMODES=beIq,k,flj,CFLMPQcgimnprstz");
+	classes.apply_isupport("NETWORK=example");
+	BOOST_CHECK(classes.get_type('h') == irc::mode_type::membership);
+	BOOST_CHECK(classes.get_type('q') == irc::mode_type::membership);
+	BOOST_CHECK(classes.get_type('f') == irc::mode_type::on_set);
+	BOOST_CHECK(classes.mode_for_symbol('%') == 'h');
+	BOOST_CHECK(classes.get_prefix_symbols() == "~&@%+");
+	BOOST_CHECK(!classes.set_prefix("(ov)@"));
+	BOOST_CHECK(classes.get_prefix_modes() == "qaohv");
+
+	args={ "a", "b", "c", "d" };
+	BOOST_CHECK(irc::parse_modes(classes, "+hhh-q", args.begin(), args.end(), md));
+	BOOST_CHECK(md.set.size() == 3);
+	BOOST_CHECK(*md.set[2].second == "c");
+	BOOST_CHECK(*md.unset[0].second == "d");
+
+	//the string form keeps working
+	md=irc::parse_modes("+ov alice bob");
+	BOOST_CHECK(md.set.size() == 2);
+	BOOST_CHECK(*md.set[1].second == "bob");
+
+	md=irc::parse_modes("-i");
+	BOOST_CHECK(md.set.empty());
+	BOOST_CHECK(md.unset.size() == 1);
+
+
+	//mode blocks only build their signal once something connects
+	irc::mode_block mb;
+	md=irc::parse_modes("+i");
+	mb.apply_mode_diff(irc::prefix { }, md);
+	BOOST_CHECK(mb.find('i') != mb.end());
+
+	int changes=0;
+	mb.connect_on_mode_change([&](const irc::prefix&, const irc::mode_diff&) { ++changes; });
+	mb.apply_mode_diff(irc::prefix { }, irc::parse_modes("-i"));
+	BOOST_CHECK(changes == 1);
+	BOOST_CHECK(mb.find('i') == mb.end());
+
+	return 0;
+}
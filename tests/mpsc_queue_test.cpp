@@ -0,0 +1,69 @@
+#define BOOST_TEST_MODULE mpsc_queue_test
+
+#include <mpsc_queue.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+int test_main(int, char **) {
+	irc::mpsc_queue<std::string> queue;
+	BOOST_CHECK(queue.empty());
+
+	std::string s;
+	BOOST_CHECK(!queue.pop(s));
+
+	queue.push("a");
+	queue.push("b");
+	queue.push("c");
+	BOOST_CHECK(!queue.empty());
+	BOOST_CHECK(queue.pop(s) && s == "a");
+
+	std::vector<std::string> out;
+	auto collect=[&](std::string v) { out.push_back(std::move(v)); };
+	BOOST_CHECK(queue.drain(collect, 1) == 1);
+	BOOST_CHECK(queue.drain(collect, 10) == 1);
+	BOOST_CHECK(out.size() == 2 && out[0] == "b" && out[1] == "c");
+	BOOST_CHECK(queue.empty());
+
+	//whatever is left is freed with the queue
+	{
+		irc::mpsc_queue<std::unique_ptr<int>> owned;
+		owned.push(std::unique_ptr<int> { new int { 1 } });
+	}
+
+	//many producers, each one's values come out in its own order
+	constexpr int producers=4, per_producer=20000;
+	irc::mpsc_queue<std::pair<int, int>> shared;
+	std::atomic<int> ready { 0 };
+	std::vector<std::thread> threads;
+	for(int p=0; p!=producers; ++p) {
+		threads.emplace_back([&, p] {
+			++ready;
+			while(ready != producers) { }
+			for(int i=0; i!=per_producer; ++i) shared.push({ p, i });
+		});
+	}
+
+	std::vector<int> next(producers, 0);
+	int total=0;
+	bool ordered=true;
+	while(total != producers*per_producer) {
+		total+=shared.drain(
+			[&](std::pair<int, int> v) {
+				if(v.second != next[v.first]) ordered=false;
+				next[v.first]=v.second+1;
+			},
+			64
+		);
+	}
+	for(auto& t : threads) t.join();
+	BOOST_CHECK(ordered);
+	BOOST_CHECK(shared.empty());
+
+	return 0;
+}
@@ -1,10 +1,12 @@
 #define BOOST_TEST_MODULE parser_tests
 
 #include <message.hpp>
+#include <message_view.hpp>
 
 #include <boost/test/minimal.hpp>
 
 #include <iostream>
+#include <iterator>
 
 int test_main(int, char **) {
 	
@@ -14,10 +16,10 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname 001 hello");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(!msg.prefix->user); 
-	BOOST_CHECK(!msg.prefix->host); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(!msg.prefix->user()); 
+	BOOST_CHECK(!msg.prefix->host()); 
 
 	BOOST_CHECK(msg.command == irc::command::RPL_WELCOME);
 	BOOST_CHECK(msg.params.size() == 1);
@@ -27,11 +29,11 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname!username 001 hello");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "username"); 
-	BOOST_CHECK(!msg.prefix->host); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "username"); 
+	BOOST_CHECK(!msg.prefix->host()); 
 
 	BOOST_CHECK(msg.command == irc::command::RPL_WELCOME);
 	BOOST_CHECK(msg.params.size() == 1);
@@ -41,11 +43,11 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname@hostname 001 hello");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(!msg.prefix->user); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "hostname"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(!msg.prefix->user()); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "hostname"); 
 
 	BOOST_CHECK(msg.command == irc::command::RPL_WELCOME);
 	BOOST_CHECK(msg.params.size() == 1);
@@ -54,12 +56,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname!username@hostname 001 hello");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "username"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "hostname"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "username"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "hostname"); 
 
 	BOOST_CHECK(msg.command == irc::command::RPL_WELCOME);
 	BOOST_CHECK(msg.params.size() == 1);
@@ -69,12 +71,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname!username@hostname 001 hello world");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "username"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "hostname"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "username"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "hostname"); 
 
 	BOOST_CHECK(msg.command == irc::command::RPL_WELCOME);
 	BOOST_CHECK(msg.params.size() == 2);
@@ -85,12 +87,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname!username@hostname 001 :foo");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "username"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "hostname"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "username"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "hostname"); 
 
 	BOOST_CHECK(msg.command == irc::command::RPL_WELCOME);
 	BOOST_CHECK(msg.params.size() == 1);
@@ -100,12 +102,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname!username@hostname 001 :foo bar baz");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "username"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "hostname"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "username"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "hostname"); 
 
 	BOOST_CHECK(msg.command == irc::command::RPL_WELCOME);
 	BOOST_CHECK(msg.params.size() == 1);
@@ -115,12 +117,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname!username@hostname 001 hello world :foo bar baz");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "username"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "hostname"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "username"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "hostname"); 
 
 	BOOST_CHECK(msg.command == irc::command::RPL_WELCOME);
 	BOOST_CHECK(msg.params.size() == 3);
@@ -132,12 +134,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname!username@hostname NICK Kilroy");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "username"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "hostname"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "username"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "hostname"); 
 
 	BOOST_CHECK(msg.command == irc::command::nick);
 	BOOST_CHECK(msg.params.size() == 1);
@@ -146,12 +148,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname!username@hostname KICK #Finnish John :Speaking English");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "username"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "hostname"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "username"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "hostname"); 
 
 	BOOST_CHECK(msg.command == irc::command::kick);
 	BOOST_CHECK(msg.params.size() == 3);
@@ -164,12 +166,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":nickname!username@hostname ERROR :Server *.fi already exists; ERROR message to the other server");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "nickname"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "username"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "hostname"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "nickname"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "username"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "hostname"); 
 
 	BOOST_CHECK(msg.command == irc::command::error);
 	BOOST_CHECK(msg.params.size() == 1);
@@ -200,12 +202,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":dobby156!~dobson@cpc17-stkp9-2-0-cust149.10-2.cable.virginm.net PRIVMSG #brownfox :a\r");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "dobby156"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "~dobson"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "cpc17-stkp9-2-0-cust149.10-2.cable.virginm.net"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "dobby156"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "~dobson"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "cpc17-stkp9-2-0-cust149.10-2.cable.virginm.net"); 
 
 	BOOST_CHECK(msg.command == irc::command::privmsg);
 	BOOST_CHECK(msg.params.size() == 2);
@@ -216,12 +218,12 @@ int test_main(int, char **) {
 	std::tie(success, msg)=irc::parse_message(":dobby156!~dobson@cpc17-stkp9-2-0-cust149.10-2.cable.virginm.net PRIVMSG #brownfox a\r");
 	BOOST_CHECK(success);
 	BOOST_CHECK(msg.prefix); 
-	BOOST_CHECK(msg.prefix->nick); 
-	BOOST_CHECK(*msg.prefix->nick == "dobby156"); 
-	BOOST_CHECK(msg.prefix->user); 
-	BOOST_CHECK(*msg.prefix->user == "~dobson"); 
-	BOOST_CHECK(msg.prefix->host); 
-	BOOST_CHECK(*msg.prefix->host == "cpc17-stkp9-2-0-cust149.10-2.cable.virginm.net"); 
+	BOOST_CHECK(msg.prefix->nick()); 
+	BOOST_CHECK(*msg.prefix->nick() == "dobby156"); 
+	BOOST_CHECK(msg.prefix->user()); 
+	BOOST_CHECK(*msg.prefix->user() == "~dobson"); 
+	BOOST_CHECK(msg.prefix->host()); 
+	BOOST_CHECK(*msg.prefix->host() == "cpc17-stkp9-2-0-cust149.10-2.cable.virginm.net"); 
 
 	BOOST_CHECK(msg.command == irc::command::privmsg);
 	BOOST_CHECK(msg.params.size() == 2);
@@ -231,5 +233,145 @@ int test_main(int, char **) {
 
 
 
+	irc::message_view view;
+	std::string raw=":nickname!username@hostname PRIVMSG #chan :hello world\r\n";
+	success=irc::parse_message(raw, view);
+	BOOST_CHECK(success);
+	BOOST_CHECK(view.prefix);
+	BOOST_CHECK(view.prefix->nick);
+	BOOST_CHECK(*view.prefix->nick == "nickname");
+	BOOST_CHECK(*view.prefix->user == "username");
+	BOOST_CHECK(*view.prefix->host == "hostname");
+	BOOST_CHECK(view.command == irc::command::privmsg);
+	BOOST_CHECK(view.size() == 2);
+	BOOST_CHECK(view[0] == "#chan");
+	BOOST_CHECK(view[1] == "hello world");
+	//views point into the original buffer
+	BOOST_CHECK(view[0].data() == raw.data() + raw.find('#'));
+
+	msg=view.to_message();
+	BOOST_CHECK(msg.prefix);
+	BOOST_CHECK(*msg.prefix->nick() == "nickname");
+	BOOST_CHECK(msg.params.size() == 2);
+	BOOST_CHECK(msg.params[1] == "hello world");
+
+	//the owning prefix keeps its parts in one buffer
+	irc::prefix server { boost::none, boost::none, std::string("irc.example.net") };
+	BOOST_CHECK(!server.nick());
+	BOOST_CHECK(!server.user());
+	BOOST_CHECK(*server.host() == "irc.example.net");
+	irc::prefix copy=*msg.prefix;
+	BOOST_CHECK(*copy.nick() == "nickname");
+	BOOST_CHECK(*copy.user() == "username");
+	BOOST_CHECK(*copy.host() == "hostname");
+	BOOST_CHECK(irc::to_string(copy) == "<nickname>!<username>@<hostname>");
+
+	success=irc::parse_message("irc.server.net 001 hello", view);
+	BOOST_CHECK(!success);
+
+	//unrecognised numerics and verbs are kept rather than rejected
+	success=irc::parse_message(":irc.server.net 999 hello", view);
+	BOOST_CHECK(success);
+	BOOST_CHECK(view.command == irc::command::unknown);
+	BOOST_CHECK(view.raw_command == "999");
+
+	success=irc::parse_message(":nick!user@host FOO bar :baz qux", view);
+	BOOST_CHECK(success);
+	BOOST_CHECK(view.command == irc::command::unknown);
+	BOOST_CHECK(view.raw_command == "FOO");
+	BOOST_CHECK(view.size() == 2);
+	BOOST_CHECK(view.to_message().raw_command == "FOO");
+
+	success=irc::parse_message("F00 bar", view);
+	BOOST_CHECK(!success);
+
+	success=irc::parse_message(":nick!user@host INVITE me #chan", view);
+	BOOST_CHECK(success);
+	BOOST_CHECK(view.command == irc::command::invite);
+	BOOST_CHECK(view.raw_command == "INVITE");
+
+	success=irc::parse_message(":irc.server.net CAP * ACK :multi-prefix", view);
+	BOOST_CHECK(success);
+	BOOST_CHECK(view.command == irc::command::cap);
+	BOOST_CHECK(view[2] == "multi-prefix");
+
+	success=irc::parse_message("PING", view);
+	BOOST_CHECK(success);
+	BOOST_CHECK(!view.prefix);
+	BOOST_CHECK(view.empty());
+
+	success=irc::parse_message("MODE #chan +ooooooooooooooo a b c d e f g h i j k l m n", view);
+	BOOST_CHECK(success);
+	BOOST_CHECK(view.size() == irc::max_params);
+	BOOST_CHECK(view[irc::max_params-1] == "m n");
+
+	raw="@time=2014-01-17T12:00:00.000Z;msgid=a\\:b\\sc\\\\d;+draft/reply;account= "
+	    ":nick!user@host PRIVMSG #chan :hi\r\n";
+	success=irc::parse_message(raw, view);
+	BOOST_CHECK(success);
+	BOOST_CHECK(view.command == irc::command::privmsg);
+	BOOST_CHECK(*view.prefix->nick == "nick");
+	BOOST_CHECK(view[1] == "hi");
+	BOOST_CHECK(!view.tags.empty());
+	BOOST_CHECK(*view.tags.find("time") == "2014-01-17T12:00:00.000Z");
+	BOOST_CHECK(view.tags.find("time")->data() == raw.data() + 6);
+	BOOST_CHECK(*view.tags.get("msgid") == "a;b c\\d");
+	BOOST_CHECK(view.tags.contains("+draft/reply"));
+	BOOST_CHECK(view.tags.find("+draft/reply")->empty());
+	BOOST_CHECK(view.tags.find("account")->empty());
+	BOOST_CHECK(!view.tags.find("batch"));
+	BOOST_CHECK(std::distance(view.tags.begin(), view.tags.end()) == 4);
+
+	msg=view.to_message();
+	BOOST_CHECK(*msg.get_tags().get("msgid") == "a;b c\\d");
+
+	success=irc::parse_message("PING :x", view);
+	BOOST_CHECK(success);
+	BOOST_CHECK(view.tags.empty());
+
+	success=irc::parse_message("@ PING :x", view);
+	BOOST_CHECK(!success);
+
+	BOOST_CHECK(*irc::message_tags("a=1;a=2").find("a") == "2");
+	irc::tag_view tag;
+	tag.value="x\\";
+	BOOST_CHECK(tag.unescaped_value() == "x");
+
+	std::vector<irc::message_view> batch;
+	std::size_t failed;
+	raw=":a 001 me :hi\r\n\r\nPING :x\n!!! bad\r\n:b PRIVMSG #c :par";
+	auto consumed=irc::parse_messages(raw, batch, failed);
+	BOOST_CHECK(consumed == raw.find(":b"));
+	BOOST_CHECK(batch.size() == 2);
+	BOOST_CHECK(failed == 1);
+	BOOST_CHECK(batch[0].command == irc::command::RPL_WELCOME);
+	BOOST_CHECK(batch[0][1] == "hi");
+	BOOST_CHECK(batch[1].command == irc::command::ping);
+
+	//the second batch reuses the storage of the first
+	auto storage=batch.data();
+	consumed=irc::parse_messages("PING :y\r\n", batch);
+	BOOST_CHECK(consumed == 9);
+	BOOST_CHECK(batch.size() == 1);
+	BOOST_CHECK(batch.data() == storage);
+	BOOST_CHECK(batch[0][0] == "y");
+
+	BOOST_CHECK(irc::to_string(irc::command::RPL_WELCOME) == "RPL_WELCOME");
+	BOOST_CHECK(irc::to_string(irc::command::privmsg) == "PRIVMSG");
+	BOOST_CHECK(irc::get_command_class(irc::command::RPL_NAMREPLY) == irc::command_class::reply);
+	BOOST_CHECK(irc::get_command_class(irc::command::ERR_NICKNAMEINUSE) == irc::command_class::error);
+	BOOST_CHECK(irc::get_command_class(irc::command::join) == irc::command_class::verb);
+	BOOST_CHECK(irc::is_command(433));
+	BOOST_CHECK(!irc::is_command(999));
+	BOOST_CHECK(!irc::is_command(-1));
+	BOOST_CHECK(!irc::is_command(irc::command_max+1));
+
+	irc::command cmd;
+	BOOST_CHECK(irc::verb_to_command("PRIVMSG", cmd) && cmd == irc::command::privmsg);
+	BOOST_CHECK(irc::verb_to_command("WHOIS", cmd) && cmd == irc::command::whois);
+	BOOST_CHECK(!irc::verb_to_command("PRIVMS", cmd));
+	BOOST_CHECK(!irc::verb_to_command("UNKNOWN", cmd));
+	BOOST_CHECK(!irc::verb_to_command("", cmd));
+
 	return 0;
 }
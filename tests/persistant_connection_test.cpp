@@ -44,7 +44,7 @@ int test_main(int, char**) {
 		);
 
 		connection.connect_on_read(
-			[&i](const std::string& msg) {
+			[&i](irc::string_view msg) {
 				BOOST_CHECK(i >= 2);
 				++i;
 				std::cout << "READ: " << msg << std::endl;
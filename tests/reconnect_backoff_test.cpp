@@ -0,0 +1,124 @@
+#include "loopback_server.hpp"
+
+#include <reconnect_backoff.hpp>
+#include <persistant_connection.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace std::chrono;
+
+namespace ba=boost::asio;
+
+int test_main(int, char**) {
+	irc::reconnect_policy policy;
+	policy.first_delay =milliseconds { 0 };
+	policy.first_spread=milliseconds { 0 };
+	policy.base_delay  =milliseconds { 5000 };
+	policy.multiplier  =2;
+	policy.max_delay   =milliseconds { 30000 };
+	policy.jitter      =0;
+	policy.max_attempts=0;
+
+	irc::reconnect_backoff backoff { policy, 1 };
+
+	//instantly, then doubling up to the cap
+	BOOST_CHECK(backoff.next_delay() == milliseconds { 0 });
+	BOOST_CHECK(backoff.next_delay() == milliseconds { 5000 });
+	BOOST_CHECK(backoff.next_delay() == milliseconds { 10000 });
+	BOOST_CHECK(backoff.next_delay() == milliseconds { 20000 });
+	BOOST_CHECK(backoff.next_delay() == milliseconds { 30000 });
+	BOOST_CHECK(backoff.next_delay() == milliseconds { 30000 });
+	BOOST_CHECK(backoff.attempts() == 6);
+	BOOST_CHECK(!backoff.exhausted());
+
+	//a successful connect starts over
+	backoff.reset();
+	BOOST_CHECK(backoff.attempts() == 0);
+	BOOST_CHECK(backoff.next_delay() == milliseconds { 0 });
+
+	//gives up after max_attempts
+	policy.max_attempts=3;
+	backoff.set_policy(policy);
+	backoff.reset();
+	backoff.next_delay();
+	backoff.next_delay();
+	BOOST_CHECK(!backoff.exhausted());
+	backoff.next_delay();
+	BOOST_CHECK(backoff.exhausted());
+
+	//jitter only ever shortens, by at most its fraction
+	policy.max_attempts=0;
+	policy.jitter      =0.5;
+	irc::reconnect_backoff jittered { policy, 42 };
+	jittered.next_delay();
+	bool varied=false;
+	irc::reconnect_backoff::duration last { };
+	for(int i=0; i!=100; ++i) {
+		auto d=jittered.next_delay();
+		auto ceiling=milliseconds { i == 0 ? 5000 : i == 1 ? 10000 : i == 2 ? 20000 : 30000 };
+		BOOST_CHECK(d <= ceiling);
+		BOOST_CHECK(d >= ceiling / 2);
+		if(i > 3 && d != last) varied=true;
+		last=d;
+	}
+	BOOST_CHECK(varied);
+
+	//the first retry is spread out too
+	policy.first_delay =milliseconds { 100 };
+	policy.first_spread=milliseconds { 1000 };
+	bool spread=false;
+	irc::reconnect_backoff::duration first { };
+	for(unsigned seed=0; seed!=20; ++seed) {
+		irc::reconnect_backoff b { policy, seed };
+		auto d=b.next_delay();
+		BOOST_CHECK(d >= milliseconds { 100 });
+		BOOST_CHECK(d <= milliseconds { 1100 });
+		if(seed != 0 && d != first) spread=true;
+		first=d;
+	}
+	BOOST_CHECK(spread);
+
+	//a server which accepts and then drops us doesn't start the curve over
+	irc::test::loopback_server server;
+	ba::io_service io_service;
+	ba::io_service::work work { io_service };
+	irc::persistant_connection conn { io_service, "127.0.0.1", server.port() };
+	policy.first_delay =milliseconds { 0 };
+	policy.first_spread=milliseconds { 0 };
+	policy.base_delay  =milliseconds { 10 };
+	policy.jitter      =0;
+	conn.set_reconnect_policy(policy);
+	//reading is how a dropped connection is noticed
+	BOOST_CHECK(irc::test::run_until(io_service, [&] { return conn.is_ready(); }));
+	conn.start_read();
+	for(std::size_t i=0; i!=3; ++i) {
+		BOOST_CHECK(irc::test::run_until(io_service,
+			[&] { return server.accepted() == i + 1 && conn.is_ready(); }));
+		server.close(i);
+		BOOST_CHECK(irc::test::run_until(io_service,
+			[&] { return conn.get_reconnect_attempts() == i + 1; }));
+	}
+
+	//a reconnect already due when the connection is destroyed is dropped
+	irc::test::loopback_server doomed_server;
+	auto doomed=std::unique_ptr<irc::persistant_connection> {
+		new irc::persistant_connection { io_service, "127.0.0.1", doomed_server.port() } };
+	policy.first_delay=milliseconds { 20 };
+	doomed->set_reconnect_policy(policy);
+	BOOST_CHECK(irc::test::run_until(io_service, [&] { return doomed->is_ready(); }));
+	doomed->start_read();
+	doomed_server.close(0);
+	BOOST_CHECK(irc::test::run_until(io_service,
+		[&] { return bool(doomed->get_next_reconnect()); }));
+	irc::test::destroy_with_timers_due(io_service, doomed, milliseconds { 50 });
+	BOOST_CHECK(!doomed);
+	io_service.poll();
+	std::this_thread::sleep_for(milliseconds { 50 });
+	BOOST_CHECK(doomed_server.accepted() == 1);
+
+	return 0;
+}
@@ -0,0 +1,158 @@
+#define BOOST_TEST_MODULE session_host_test
+
+#include "loopback_server.hpp"
+
+#include <session_host.hpp>
+#include <session.hpp>
+#include <persistant_connection.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ba=boost::asio;
+
+using irc::test::loopback_server;
+using irc::test::wait_for;
+
+int test_main(int, char **) {
+	loopback_server server { "", irc::test::welcome };
+	const std::string port=server.port();
+
+	irc::session_host host { 2 };
+	BOOST_CHECK(host.get_thread_count() == 2);
+
+	std::vector<irc::session_host::session_id> ids;
+	for(int i=0; i!=4; ++i) {
+		std::string nick="bot" + std::to_string(i);
+		ids.push_back(host.add_session(
+			[port, nick](ba::io_service& io) {
+				std::unique_ptr<irc::persistant_connection> conn {
+					new irc::persistant_connection { io, "127.0.0.1", port } };
+				return std::unique_ptr<irc::session> {
+					new irc::session { std::move(conn), nick, "user", "real" } };
+			}
+		));
+	}
+
+	//spread evenly
+	auto stats=host.get_stats();
+	BOOST_CHECK(stats.size() == 2);
+	BOOST_CHECK(stats[0].sessions == 2);
+	BOOST_CHECK(stats[1].sessions == 2);
+
+	//every session is reached on its own thread
+	std::mutex                   mutex;
+	std::set<std::string>        nicks;
+	std::set<std::thread::id>    threads;
+	std::atomic<int>             visited { 0 };
+	for(auto id : ids) {
+		host.post(id,
+			[&](irc::session& s) {
+				std::lock_guard<std::mutex> lock { mutex };
+				nicks.insert(s.get_nick());
+				threads.insert(std::this_thread::get_id());
+				++visited;
+			}
+		);
+	}
+	BOOST_CHECK(wait_for([&] { return visited == 4; }));
+	BOOST_CHECK(nicks.size() == 4);
+	BOOST_CHECK(threads.size() == 2);
+
+	//removed sessions are no longer reachable
+	host.remove_session(ids[0]);
+	host.post(ids[0], [&](irc::session&) { ++visited; });
+	host.post(ids[1], [&](irc::session&) { ++visited; });
+	BOOST_CHECK(wait_for([&] { return visited == 5; }));
+	BOOST_CHECK(wait_for([&] {
+		auto s=host.get_stats();
+		return s[0].sessions + s[1].sessions == 3;
+	}));
+	BOOST_CHECK(visited == 5);
+
+	//lines posted from other threads all arrive, in order per thread
+	auto poster_id=host.add_session(
+		[port](ba::io_service& io) {
+			std::unique_ptr<irc::persistant_connection> conn {
+				new irc::persistant_connection { io, "127.0.0.1", port } };
+			irc::flood_limits unlimited;
+			unlimited.lines=0;
+			unlimited.bytes=0;
+			conn->set_flood_limits(unlimited);
+			return std::unique_ptr<irc::session> {
+				new irc::session { std::move(conn), "poster", "user", "real" } };
+		}
+	);
+	//producers only ever get a handle, never the session itself
+	std::promise<irc::session::write_handle> handed_over;
+	host.post(poster_id,
+		[&](irc::session& s) { handed_over.set_value(s.get_write_handle()); });
+	auto handle_future=handed_over.get_future();
+	BOOST_CHECK(handle_future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+	const irc::session::write_handle poster=handle_future.get();
+
+	const int per_thread=1000;
+	std::vector<std::thread> posters;
+	for(int t=0; t!=3; ++t) {
+		posters.emplace_back(
+			[&, t] {
+				//each thread its own copy
+				irc::session::write_handle handle=poster;
+				for(int i=0; i!=per_thread; ++i)
+					handle.post_privmsg("#t" + std::to_string(t), std::to_string(i));
+			}
+		);
+	}
+	for(auto& t : posters) t.join();
+
+	auto privmsgs=[&] {
+		std::vector<std::string> lines;
+		for(auto& line : server.received())
+			if(line.compare(0, 10, "PRIVMSG #t") == 0) lines.push_back(line);
+		return lines;
+	};
+	BOOST_CHECK(wait_for([&] { return privmsgs().size() == 3 * per_thread; }));
+	int next[3]={ 0, 0, 0 };
+	bool ordered=true;
+	for(auto& line : privmsgs()) {
+		int t=line[10] - '0';
+		if(line != "PRIVMSG #t" + std::to_string(t) + " :" + std::to_string(next[t]))
+			ordered=false;
+		++next[t];
+	}
+	BOOST_CHECK(ordered);
+
+	//a session removed with lines still in flight drops them, the drains
+	//already posted only find an outbox without an owner
+	irc::session::write_handle late=poster;
+	for(int i=0; i!=per_thread; ++i)
+		late.post_privmsg("#late", std::to_string(i));
+	host.remove_session(poster_id);
+	BOOST_CHECK(wait_for([&] {
+		auto s=host.get_stats();
+		return s[0].sessions + s[1].sessions == 3;
+	}));
+
+	//and a handle outliving its session drops what it is given
+	late.post_privmsg("#gone", "hello?");
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	bool gone_sent=false;
+	for(auto& line : server.received())
+		if(line.compare(0, 13, "PRIVMSG #gone") == 0) gone_sent=true;
+	BOOST_CHECK(!gone_sent);
+
+	stats=host.get_stats();
+	BOOST_CHECK(stats[0].handlers > 0);
+	BOOST_CHECK(stats[0].errors == 0);
+	BOOST_CHECK(stats[1].errors == 0);
+
+	return 0;
+}
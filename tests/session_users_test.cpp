@@ -0,0 +1,63 @@
+#include "loopback_server.hpp"
+
+#include <session.hpp>
+#include <persistant_connection.hpp>
+#include <user.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <memory>
+#include <set>
+#include <string>
+
+namespace ba=boost::asio;
+
+using irc::test::loopback_server;
+using irc::test::run_until;
+
+namespace {
+
+std::set<std::string> tracked(const irc::session& s) {
+	std::set<std::string> nicks;
+	for(auto it=s.begin_users(); it!=s.end_users(); ++it)
+		nicks.insert(it->get_nick());
+	return nicks;
+}
+
+} //namespace
+
+int test_main(int, char**) {
+	loopback_server server;
+	ba::io_service io_service;
+	//polling an io_service with nothing to do would stop it
+	ba::io_service::work work { io_service };
+
+	std::unique_ptr<irc::persistant_connection> conn {
+		new irc::persistant_connection { io_service, "127.0.0.1", server.port() } };
+	irc::session s { std::move(conn), "me", "user", "real" };
+	BOOST_CHECK(run_until(io_service, [&] { return server.accepted() == 1; }));
+
+	server.send(0,
+		":me!u@h JOIN #a\r\n"
+		":me!u@h JOIN #b\r\n"
+		":alice!u@h JOIN #a\r\n"
+		":bob!u@h JOIN #a\r\n"
+		":bob!u@h JOIN #b\r\n");
+	BOOST_CHECK(run_until(io_service, [&] {
+		return tracked(s) == std::set<std::string> { "me", "alice", "bob" };
+	}));
+
+	//leaving #a forgets alice, bob is still seen in #b
+	server.send(0, ":me!u@h PART #a\r\n");
+	BOOST_CHECK(run_until(io_service, [&] {
+		return tracked(s) == std::set<std::string> { "me", "bob" };
+	}));
+
+	//and once bob leaves #b there is nowhere left we see him
+	server.send(0, ":bob!u@h PART #b\r\n");
+	BOOST_CHECK(run_until(io_service, [&] {
+		return tracked(s) == std::set<std::string> { "me" };
+	}));
+
+	return 0;
+}
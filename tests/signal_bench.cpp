@@ -0,0 +1,58 @@
+// Compares boost::signals2 with light_signal on the shape of the
+// session::handle_privmsg fan-out: every channel PRIVMSG emits the
+// channel's on_message and then the sender's on_channel_message, both
+// with the text passed by const reference.
+//
+//   make bench OPTS=-O2 && ./signal_bench [messages]
+
+#include <light_signal.hpp>
+
+#include <boost/signals2.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+struct fake_channel { };
+struct fake_user    { };
+
+using signature=void(fake_channel&, fake_user&, const std::string&);
+
+template<typename Signal>
+double run(unsigned subscribers, unsigned long messages, unsigned long& sink) {
+	fake_channel chan;
+	fake_user    usr;
+	Signal on_message, on_channel_message;
+	for(unsigned i=0; i!=subscribers; ++i) {
+		on_message.connect([&](fake_channel&, fake_user&, const std::string& s) { sink+=s.size(); });
+		on_channel_message.connect([&](fake_channel&, fake_user&, const std::string& s) { ++sink; });
+	}
+
+	const std::string text="the quick brown fox jumps over the lazy dog";
+	auto start=std::chrono::steady_clock::now();
+	for(unsigned long i=0; i!=messages; ++i) {
+		on_message(chan, usr, text);
+		on_channel_message(chan, usr, text);
+	}
+	std::chrono::duration<double, std::nano> took=std::chrono::steady_clock::now() - start;
+	return took.count() / messages;
+}
+
+} //namespace
+
+int main(int argc, char** argv) {
+	unsigned long messages=argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+	unsigned long sink=0;
+
+	std::cout << "subscribers  signals2 ns/msg  light_signal ns/msg\n";
+	for(unsigned subscribers : { 0, 1, 4 }) {
+		double heavy=run<boost::signals2::signal<signature>>(subscribers, messages, sink);
+		double light=run<irc::light_signal<signature>>(subscribers, messages, sink);
+		std::cout << subscribers << "\t\t" << heavy << "\t\t" << light << '\n';
+	}
+	//keeps the slots from being optimised away
+	std::cerr << sink << '\n';
+}
@@ -0,0 +1,58 @@
+#define BOOST_TEST_MODULE slab_pool_test
+
+#include <slab_pool.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct object {
+	std::string  name;
+	std::int64_t value;
+	object(std::string n, std::int64_t v) : name(std::move(n)), value(v) { }
+};
+
+int test_main(int, char **) {
+	auto pool=std::make_shared<irc::slab_pool>(4);
+	irc::slab_allocator<object> alloc { pool };
+
+	std::vector<std::shared_ptr<object>> objects;
+	for(int i=0; i!=10; ++i) {
+		objects.push_back(std::allocate_shared<object>(alloc, "obj", i));
+	}
+	BOOST_CHECK(pool->in_use() == 10);
+	BOOST_CHECK(pool->slab_count() == 3);
+	for(const auto& o : objects) {
+		BOOST_CHECK(reinterpret_cast<std::uintptr_t>(o.get()) % alignof(std::max_align_t) == 0);
+	}
+
+	//a freed block is the next one handed out
+	auto* freed=objects[3].get();
+	objects[3].reset();
+	BOOST_CHECK(pool->in_use() == 9);
+	objects[3]=std::allocate_shared<object>(alloc, "again", 3);
+	BOOST_CHECK(objects[3].get() == freed);
+	BOOST_CHECK(objects[3]->name == "again");
+	BOOST_CHECK(pool->slab_count() == 3);
+
+	//churn stays within the slabs already taken
+	for(int round=0; round!=100; ++round) {
+		objects.clear();
+		for(int i=0; i!=10; ++i)
+			objects.push_back(std::allocate_shared<object>(alloc, "churn", i));
+	}
+	BOOST_CHECK(pool->slab_count() == 3);
+
+	//objects keep the pool alive
+	std::weak_ptr<irc::slab_pool> weak=pool;
+	pool.reset();
+	alloc=irc::slab_allocator<object> { std::make_shared<irc::slab_pool>() };
+	BOOST_CHECK(!weak.expired());
+	objects.clear();
+	BOOST_CHECK(weak.expired());
+
+	return 0;
+}
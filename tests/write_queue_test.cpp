@@ -0,0 +1,42 @@
+#include <write_queue.hpp>
+
+#include <boost/asio/buffer.hpp>
+
+#include <boost/test/minimal.hpp>
+
+#include <string>
+
+namespace ba=boost::asio;
+
+int test_main(int, char**) {
+	irc::write_queue wq { 20 };
+
+	BOOST_CHECK(wq.push("PRIVMSG #a :1\r\n"));
+	//nothing is in flight yet, so every push asks for a write
+	BOOST_CHECK(wq.push("PING :x\r\n"));
+
+	auto& bufs=wq.prepare();
+	//15 + 9 bytes exceeds the cap, only the first is gathered
+	BOOST_CHECK(bufs.size() == 1);
+	BOOST_CHECK(wq.in_flight() == 1);
+	BOOST_CHECK(!wq.push("PING :y\r\n"));
+
+	BOOST_CHECK(wq.consume());
+	BOOST_CHECK(wq.size() == 2);
+
+	auto& next=wq.prepare();
+	BOOST_CHECK(next.size() == 2);
+	BOOST_CHECK(ba::buffer_size(next) == 18);
+	BOOST_CHECK(std::string(ba::buffer_cast<const char*>(next[1]),
+		ba::buffer_size(next[1])) == "PING :y\r\n");
+	BOOST_CHECK(!wq.consume());
+	BOOST_CHECK(wq.empty());
+
+	//an oversized message is still written whole
+	wq.push(std::string(64, 'z'));
+	BOOST_CHECK(ba::buffer_size(wq.prepare()) == 64);
+	wq.clear();
+	BOOST_CHECK(wq.empty() && wq.in_flight() == 0);
+
+	return 0;
+}